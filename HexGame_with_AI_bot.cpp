@@ -13,6 +13,10 @@
 // - Hex_Game is the class that makes a game object. Such game object manages the game flow, makes the
 // moves and checks if any player has won after each move. It contains the Hex board and all the
 // required stuff. Now it also contains the implementation of the bot opponent using Monte Carlo simulation
+// - On small boards (up to MAX_SOLVER_BORDER_LENGTH) the bot first asks the exact solver Hex_Solver
+// (proof-number search) and plays at once any move that is proven to win. Solved positions are cached
+// in a file per board size (hex_solver_cache_NxN.bin), keyed by the canonical hash of Position_Hasher
+// (which identifies the positions that are equivalent by the symmetries of the board).
 // ---------------------------------------------------------------------------------------------------
 // Some auxiliary classes are needed for certain operations and data managing. Those classes
 // are PriorityQueue, bool_and_num_Pair, int_and_num_Pair and int_int_and_num_Triad.
@@ -31,9 +35,33 @@
 #include <stdio.h> // (In some cases, old C printf() will be used to print formatted text)
 #include <typeinfo>
 #include <utility>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <array>
+#include <cstring>
+#include <cstdlib>
+#include <sys/mman.h> // (mmap is used to read the opening book. POSIX systems only)
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cmath>
+#include <thread> // (The parallel graph generator needs linking with -pthread)
+#include <chrono>
+#include <sstream>
+#include <queue>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <iomanip>
+#include <cctype>
+#include <condition_variable>
 using namespace std;
 
 typedef enum representationMode{CON_MATRIX, EDGE_LIST} representationMode;
+typedef enum solverResult{SOLVER_UNKNOWN, SOLVER_WIN, SOLVER_LOSS} solverResult; // Results of the exact solver, seen
+// from the point of view of the player to move
 
 // The pseudorandom generator will be used as specified in https://en.cppreference.com/w/cpp/numeric/random/uniform_real_distribution
 // This produces random floating-point values uniformly distributed on the interval [a,b)
@@ -41,11 +69,16 @@ std::mt19937 gen(time(0)); // Standard mersenne_twister_engine seeded time(0)
 std::uniform_real_distribution<float> probability_having_edge(0.0, 1.0);
 std::uniform_real_distribution<double> cost_value(0.0, 10.0);
 
-std::uniform_real_distribution<double> probability_using_swap(0.0, 1.0); // Probability that is used in Monte Carlo Bot opponent
-
-auto randengine = std::default_random_engine {}; // Needed for shuffling vectors using STL
-
 int const N_MC_ITERATIONS = 750; // How many simulations for each movement in Monte Carlo bot opponent
+int const MAX_SOLVER_BORDER_LENGTH = 7; // The exact solver is only used on boards up to this border length
+long const SOLVER_MAX_NODES = 50000; // Node budget of the exact solver for each bot move
+double const PRIOR_BIAS_WEIGHT = 1.0; // Weight of the pattern prior in the bot's choice (see MonteCarlo_Bot::prior_bias)
+int const MIN_ENGINE_BORDER_LENGTH = 3; // Board sizes with a compile-time specialized playout engine (see Engine)
+int const MAX_ENGINE_BORDER_LENGTH = 19;
+bool const EARLY_PLAYOUT_CUTOFF = false; // The bot's random games stop as soon as a player connects (see
+// Engine::random_game). Slower than filling the bitboards, but it counts how long the random games are
+bool const SEQUENTIAL_HALVING = true; // The bot shares out its random games between its candidate moves by sequential
+// halving, instead of the same number for each one (see MonteCarlo_Bot::sequential_halving)
 
 namespace Graph{
     // ===============================================================================================
@@ -56,8 +89,8 @@ namespace Graph{
         public:
             bool_and_num_Pair():_bool(false),_val(static_cast<numType>(0)){} // Default constructor
             bool_and_num_Pair(bool bvalue, numType val):_bool(bvalue),_val(val){}
-            bool get_bool(){return _bool;}
-            numType get_value(){return _val;}
+            bool get_bool() const{return _bool;}
+            numType get_value() const{return _val;}
             void set_bool(bool input){_bool=input; return;}
             void set_value(numType input){_val=input; return;}
             void set_pair(bool bool_value, numType num_value){_bool=bool_value; _val=num_value; return;}
@@ -72,8 +105,8 @@ namespace Graph{
         public:
             int_and_num_Pair():_val1(0),_val2(static_cast<numType>(0)){} // Default constructor
             int_and_num_Pair(int val1, numType val2):_val1(val1),_val2(val2){}
-            int get_value1(){return _val1;}
-            numType get_value2(){return _val2;}
+            int get_value1() const{return _val1;}
+            numType get_value2() const{return _val2;}
             void set_value1(int val1){_val1=val1; return;}
             void set_value2(numType val2){_val2=val2; return;}
             void set_pair(int val1, numType val2){_val1=val1; _val2=val2; return;}
@@ -88,9 +121,9 @@ namespace Graph{
         public:
             int_int_and_num_Triad():_val1(0),_val2(0),_val3(static_cast<numType>(0)){} // Default constructor
             int_int_and_num_Triad(int val1, int val2, numType val3):_val1(val1),_val2(val2),_val3(val3){}
-            int get_value1(){return _val1;}
-            int get_value2(){return _val2;}
-            numType get_value3(){return _val3;}
+            int get_value1() const{return _val1;}
+            int get_value2() const{return _val2;}
+            numType get_value3() const{return _val3;}
             void set_value1(int val1){_val1=val1; return;}
             void set_value2(int val2){_val2=val2; return;}
             void set_value3(numType val3){_val3=val3; return;}
@@ -109,62 +142,97 @@ namespace Graph{
     class Graph{
 
         protected:
+            struct Topology; // (Defined with the members, below)
+
             // Constructors:
             // =============
-            Graph(int size, representationMode rep):size(size),preferredRepresentation(rep),\
+            Graph(int size, representationMode rep):size(size),topology(make_shared<Topology>()),preferredRepresentation(rep),\
             conMatrix_was_computed(false),edgeList_was_computed(false){}
 
-            Graph(int size, representationMode rep, vector<numType> nodeValues):size(size),preferredRepresentation(rep),\
-            nodeValues(nodeValues),conMatrix_was_computed(false),edgeList_was_computed(false){}
+            Graph(int size, representationMode rep, vector<numType> nodeValues):size(size),topology(make_shared<Topology>()),\
+            preferredRepresentation(rep),nodeValues(nodeValues),conMatrix_was_computed(false),edgeList_was_computed(false){}
 
-            // Copy constructor:
-            Graph(const Graph<numType>& sample):size(sample.V()),connectivityMatrix(sample.private_getConMatrix()),\
-            edgeList(sample.private_getEdgeList()),preferredRepresentation(sample.get_preferredRepresentation()),\
+            // Copy constructor. The topology is shared, not copied (see detach_topology):
+            Graph(const Graph<numType>& sample):size(sample.V()),topology(sample.private_getTopology()),\
+            preferredRepresentation(sample.get_preferredRepresentation()),\
             nodeValues(sample.get_nodeValues()),nodeTags(sample.get_nodeTags()),\
             conMatrix_was_computed(sample.get_conMatrixWasComputed()),\
             edgeList_was_computed(sample.get_edgeListWasComputed()){}
 
+            // Move constructor. The sample is left as an empty graph:
+            Graph(Graph<numType>&& sample):size(sample.size),topology(move(sample.topology)),\
+            preferredRepresentation(sample.preferredRepresentation),nodeValues(move(sample.nodeValues)),\
+            nodeTags(move(sample.nodeTags)),conMatrix_was_computed(sample.conMatrix_was_computed),\
+            edgeList_was_computed(sample.edgeList_was_computed){
+                sample.topology = make_shared<Topology>();
+                sample.conMatrix_was_computed = false;
+                sample.edgeList_was_computed = false;
+            }
+
+            Graph<numType>& operator=(const Graph<numType>& sample){ // Copy assignment (sharing the topology too)
+                size = sample.size;
+                topology = sample.topology;
+                preferredRepresentation = sample.preferredRepresentation;
+                nodeValues = sample.nodeValues;
+                nodeTags = sample.nodeTags;
+                conMatrix_was_computed = sample.conMatrix_was_computed;
+                edgeList_was_computed = sample.edgeList_was_computed;
+                return *this;
+            }
+
+            Graph<numType>& operator=(Graph<numType>&& sample){ // Move assignment
+                if(this!=&sample){
+                    size = sample.size;
+                    topology = move(sample.topology);
+                    preferredRepresentation = sample.preferredRepresentation;
+                    nodeValues = move(sample.nodeValues);
+                    nodeTags = move(sample.nodeTags);
+                    conMatrix_was_computed = sample.conMatrix_was_computed;
+                    edgeList_was_computed = sample.edgeList_was_computed;
+                    sample.topology = make_shared<Topology>();
+                    sample.conMatrix_was_computed = false;
+                    sample.edgeList_was_computed = false;
+                }
+                return *this;
+            }
+
         public:
             // Common methods for the derived classes:
             // =======================================
-            ~Graph(){ // Destructor
-                conMatrix_destruction();
-                edgeList_destruction();
-            }
+            ~Graph(){} // Destructor (the topology is freed by its shared_ptr, when no other copy uses it)
 
             void conMatrix_destruction(){ // A submethod for destructing
-                for(int i=0; i<connectivityMatrix.size(); ++i){
-                    connectivityMatrix[i].clear();
-                }
-                connectivityMatrix.clear();
+                sync_edgeList(); // (The dirty rows of the edge list can't be rebuilt without the matrix)
+                detach_topology();
+                topology->adjacencyBits.clear();
+                topology->edgeCosts.clear();
+                topology->matrix_n_edges = 0;
                 return;
             }
 
             void edgeList_destruction(){ // A submethod for destructing
-                for(int i=0; i<edgeList.size(); ++i){
-                    edgeList[i].clear();
+                detach_topology();
+                for(int i=0; i<topology->edgeList.size(); ++i){
+                    topology->edgeList[i].clear();
                 }
-                edgeList.clear();
+                topology->edgeList.clear();
+                topology->edgeList_dirty_rows.clear();
+                topology->edgeList_row_is_dirty.clear();
                 return;
             }
 
             void generate_conMatrix_from_edgeList(){
                 if(edgeList_was_computed==true){
+                    sync_edgeList(); // (If there's a matrix, the rows of the list may be out of date)
                     // Reset the matrix and initialize it to false. Then copy the info from the edge list
-                    conMatrix_destruction();
-                    for(int i=0; i<size; ++i){
-                        connectivityMatrix.push_back(vector<bool_and_num_Pair<numType>>());
-                        for(int j=0; j<size; ++j){
-                            connectivityMatrix[i].push_back(bool_and_num_Pair(false, 0));
-                        }
-                    }
+                    conMatrix_allocate();
                     int auxIndex;
                     numType costAux;
                     for(int i=0; i<size; ++i){
-                        for(int j=0; j<edgeList[i].size(); ++j){
-                            auxIndex = edgeList[i][j].get_value1();
-                            costAux = edgeList[i][j].get_value2();
-                            connectivityMatrix[i][auxIndex] = bool_and_num_Pair(true, costAux);
+                        for(int j=0; j<topology->edgeList[i].size(); ++j){
+                            auxIndex = topology->edgeList[i][j].get_value1();
+                            costAux = topology->edgeList[i][j].get_value2();
+                            matrix_set(i, auxIndex, true, costAux);
                         }
                     }
                     conMatrix_was_computed = true;
@@ -181,16 +249,11 @@ namespace Graph{
                     // Clear and initialize the vector. Then copy the info from the connectivity matrix
                     edgeList_destruction();
 
-                    numType costAux;
                     for(int i=0; i<size; ++i){
-                        edgeList.push_back(vector<int_and_num_Pair<numType>>());
-                        for(int j=0; j<size; ++j){
-                            if(connectivityMatrix[i][j].get_bool()==true){
-                                costAux = connectivityMatrix[i][j].get_value();
-                                edgeList[i].push_back(int_and_num_Pair(j, costAux));
-                            }
+                        topology->edgeList.push_back(vector<int_and_num_Pair<numType>>());
+                        matrix_row_neighbors(i, topology->edgeList[i]);
                     }
-                }
+                    topology->edgeList_row_is_dirty.assign(size, false);
                     edgeList_was_computed = true;
                     return;
                 }else{
@@ -206,19 +269,11 @@ namespace Graph{
 
             int E() const{ // Returns the number of edges of the graph
                 int count = 0;
-                if(edgeList_was_computed==true){
-                    for(int i=0; i<size; ++i){
-                        count += edgeList[i].size();
-                    }
-                    return count;
-                }else if (conMatrix_was_computed==true)
-                {
+                if(conMatrix_was_computed==true){ // The matrix keeps the count of its edges up to date
+                    return topology->matrix_n_edges;
+                }else if(edgeList_was_computed==true){
                     for(int i=0; i<size; ++i){
-                        for(int j=0; j<size; ++j){
-                            if(connectivityMatrix[i][j].get_bool()==true){
-                                ++count;
-                            }
-                        }
+                        count += topology->edgeList[i].size();
                     }
                     return count;
                 }else{
@@ -228,19 +283,19 @@ namespace Graph{
             }
 
             bool adjacent(int nodeFrom, int nodeTo){ // Returns true if there's adjacency from a node "From" to another node "To"
-                if(edgeList_was_computed==true){
-                    for(int j=0; j<edgeList[nodeFrom].size(); ++j){
-                        if(edgeList[nodeFrom][j].get_value1()==nodeTo){
-                            return true;
-                        }
-                    }
-                    return false;
-                }else if(conMatrix_was_computed==true){
-                    if(connectivityMatrix[nodeFrom][nodeTo].get_bool()==true){
+                if(conMatrix_was_computed==true){ // A single bit test
+                    if(matrix_get_bool(nodeFrom,nodeTo)==true){
                         return true;
                     }else{
                         return false;
                     }
+                }else if(edgeList_was_computed==true){
+                    for(int j=0; j<topology->edgeList[nodeFrom].size(); ++j){
+                        if(topology->edgeList[nodeFrom][j].get_value1()==nodeTo){
+                            return true;
+                        }
+                    }
+                    return false;
                 }else{
                     cout<<"Neither Connectivity matrix nor Edge list was computed. Returning false."<<endl;
                     return false;
@@ -249,16 +304,11 @@ namespace Graph{
 
             vector<int_and_num_Pair<numType>> neighbors(int nodeFrom){ // Lists the nodes to which we can go from "nodeFrom", along with the costs
                 if(edgeList_was_computed==true){
-                    return edgeList[nodeFrom];
+                    sync_edgeList_row(nodeFrom);
+                    return topology->edgeList[nodeFrom];
                 }else if(conMatrix_was_computed==true){
                     vector<int_and_num_Pair<numType>> output;
-                    numType costAux;
-                    for(int j=0; j<size; ++j){
-                        if(connectivityMatrix[nodeFrom][j].get_bool()==true){
-                            costAux = connectivityMatrix[nodeFrom][j].get_value();
-                            output.push_back(int_and_num_Pair(j, costAux));
-                        }
-                    }
+                    matrix_row_neighbors(nodeFrom, output);
                     return output;
                 }else{
                     cout<<"Neither Connectivity matrix nor Edge list was computed. Returning empty vector."<<endl;
@@ -266,6 +316,113 @@ namespace Graph{
                 }
             }
 
+            // Neighbors without copies:
+            // =========================
+            // neighbors() returns a new vector. For traversals, neighbor_view() gives the same nodes and
+            // costs, in the same order, without allocating: it walks the row of the edge list in place,
+            // or the set bits of the row of the adjacency bitmap. The view is valid while the graph
+            // isn't changed. for_each_neighbor() calls callback(node, cost) for each neighbor instead.
+            class Neighbor_Iterator{
+                public:
+                    Neighbor_Iterator(const Graph<numType>* graph, const int_and_num_Pair<numType>* list_position,\
+                    int nodeFrom, int word, uint64_t bits):graph(graph),list_position(list_position),nodeFrom(nodeFrom),\
+                    word(word),bits(bits){
+                        skip_empty_words();
+                    }
+
+                    int_and_num_Pair<numType> operator*() const{
+                        if(list_position!=nullptr){
+                            return *list_position;
+                        }
+                        int nodeTo = (word<<6)+__builtin_ctzll(bits);
+                        return int_and_num_Pair<numType>(nodeTo, graph->matrix_get_value(nodeFrom, nodeTo));
+                    }
+
+                    Neighbor_Iterator& operator++(){
+                        if(list_position!=nullptr){
+                            ++list_position;
+                        }else{
+                            bits &= bits-1; // Clear the lowest set bit
+                            skip_empty_words();
+                        }
+                        return *this;
+                    }
+
+                    bool operator!=(const Neighbor_Iterator& other) const{
+                        return list_position!=other.list_position || word!=other.word || bits!=other.bits;
+                    }
+
+                private:
+                    void skip_empty_words(){ // (Bitmap rows only) Move on to the next word with set bits
+                        if(list_position!=nullptr || graph==nullptr){
+                            return;
+                        }
+                        int row_words = graph->matrix_row_words();
+                        while(bits==0 && word<row_words-1){
+                            ++word;
+                            bits = graph->topology->adjacencyBits[static_cast<size_t>(nodeFrom)*row_words+word];
+                        }
+                        if(bits==0){ // End of the row
+                            word = row_words;
+                        }
+                        return;
+                    }
+
+                    const Graph<numType>* graph;
+                    const int_and_num_Pair<numType>* list_position; // Position in the edge list row (or nullptr)
+                    int nodeFrom;
+                    int word; // Position in the bitmap row
+                    uint64_t bits; // Bits of that word still to be visited
+            };
+
+            class Neighbor_View{
+                public:
+                    Neighbor_View(Neighbor_Iterator first, Neighbor_Iterator last):first(first),last(last){}
+                    Neighbor_Iterator begin() const{return first;}
+                    Neighbor_Iterator end() const{return last;}
+
+                private:
+                    Neighbor_Iterator first;
+                    Neighbor_Iterator last;
+            };
+
+            Neighbor_View neighbor_view(int nodeFrom){
+                if(edgeList_was_computed==true){
+                    sync_edgeList_row(nodeFrom);
+                    const int_and_num_Pair<numType>* row = topology->edgeList[nodeFrom].data();
+                    return Neighbor_View(Neighbor_Iterator(this, row, nodeFrom, 0, 0),\
+                    Neighbor_Iterator(this, row+topology->edgeList[nodeFrom].size(), nodeFrom, 0, 0));
+                }else if(conMatrix_was_computed==true){
+                    int row_words = matrix_row_words();
+                    return Neighbor_View(Neighbor_Iterator(this, nullptr, nodeFrom, 0,\
+                    topology->adjacencyBits[static_cast<size_t>(nodeFrom)*row_words]), Neighbor_Iterator(this, nullptr, nodeFrom, row_words, 0));
+                }else{
+                    cout<<"Neither Connectivity matrix nor Edge list was computed. Returning empty view."<<endl;
+                    return Neighbor_View(Neighbor_Iterator(nullptr, nullptr, nodeFrom, 0, 0),\
+                    Neighbor_Iterator(nullptr, nullptr, nodeFrom, 0, 0));
+                }
+            }
+
+            template<typename neighborCallback>
+            void for_each_neighbor(int nodeFrom, neighborCallback callback){
+                if(edgeList_was_computed==true){
+                    sync_edgeList_row(nodeFrom);
+                    for(const int_and_num_Pair<numType>& neighbor : topology->edgeList[nodeFrom]){
+                        callback(neighbor.get_value1(), neighbor.get_value2());
+                    }
+                }else if(conMatrix_was_computed==true){
+                    int row_words = matrix_row_words();
+                    const uint64_t* row = topology->adjacencyBits.data()+static_cast<size_t>(nodeFrom)*row_words;
+                    for(int w=0; w<row_words; ++w){
+                        for(uint64_t bits=row[w]; bits!=0; bits&=bits-1){
+                            int nodeTo = (w<<6)+__builtin_ctzll(bits);
+                            callback(nodeTo, matrix_get_value(nodeFrom, nodeTo));
+                        }
+                    }
+                }
+                return;
+            }
+
             numType get_node_value(int i) const{ // Returns the value associated with the node i
                 return nodeValues[i];
             }
@@ -299,25 +456,25 @@ namespace Graph{
             }
 
             numType get_edge_value(int nodeFrom, int nodeTo) const{ // Returns the value (the cost) associated to the edge from nodeFrom to nodeTo
-                if(edgeList_was_computed==true){
+                if(conMatrix_was_computed==true){
+                    if(matrix_get_bool(nodeFrom,nodeTo)==true){
+                        return matrix_get_value(nodeFrom,nodeTo);
+                    }else{
+                        cout<<"Edge from node "<<nodeFrom<<" to node "<<nodeTo<<" doesn't exist."<<endl;
+                        return 0;
+                    }
+                }else if(edgeList_was_computed==true){
                     bool edgeFound = false;
                     numType costVal = 0;
-                    for(int j=0; j<edgeList[nodeFrom].size(); ++j){
-                        if(edgeList[nodeFrom][j].get_value1()==nodeTo){
+                    for(int j=0; j<topology->edgeList[nodeFrom].size(); ++j){
+                        if(topology->edgeList[nodeFrom][j].get_value1()==nodeTo){
                             edgeFound = true;
-                            costVal = edgeList[nodeFrom][j].get_value2();
+                            costVal = topology->edgeList[nodeFrom][j].get_value2();
                             return costVal;
                         }
                     }
                     cout<<"Edge from node "<<nodeFrom<<" to node "<<nodeTo<<" doesn't exist."<<endl;
                     return costVal;
-                }else if(conMatrix_was_computed==true){
-                    if(connectivityMatrix[nodeFrom][nodeTo].get_bool()==true){
-                        return connectivityMatrix[nodeFrom][nodeTo].get_value();
-                    }else{
-                        cout<<"Edge from node "<<nodeFrom<<" to node "<<nodeTo<<" doesn't exist."<<endl;
-                        return 0;
-                    }
                 }else{
                     cout<<"Neither connectivity matrix nor edge list have been computed. Graph is empty!"<<endl;
                     return 0;
@@ -344,7 +501,7 @@ namespace Graph{
                     unsigned long int a9=0;
                     long long int a10=0;
                     unsigned long long int a11=0;
-                    numType checker = connectivityMatrix[0][0].get_value();
+                    numType checker = matrix_get_value(0,0);
                     if(typeid(checker).name()==typeid(a1).name()||\
                     typeid(checker).name()==typeid(a2).name()||typeid(checker).name()==typeid(a3).name()||\
                     typeid(checker).name()==typeid(a4).name()||typeid(checker).name()==typeid(a5).name()||\
@@ -359,7 +516,7 @@ namespace Graph{
                         for(int i=0; i<size; ++i){
                             printf("%4d: ", i);
                             for(int j=0; j<size; ++j){
-                                printf(" %4d(%3d)", connectivityMatrix[i][j].get_bool(), connectivityMatrix[i][j].get_value());
+                                printf(" %4d(%3d)", matrix_get_bool(i,j), matrix_get_value(i,j));
                             }
                             cout<<""<<endl;
                         }
@@ -372,7 +529,7 @@ namespace Graph{
                         for(int i=0; i<size; ++i){
                             printf("%4d: ", i);
                             for(int j=0; j<size; ++j){
-                                printf(" %4d(%8.4f)", connectivityMatrix[i][j].get_bool(), connectivityMatrix[i][j].get_value());
+                                printf(" %4d(%8.4f)", matrix_get_bool(i,j), matrix_get_value(i,j));
                             }
                             cout<<""<<endl;
                         }
@@ -394,11 +551,12 @@ namespace Graph{
                 cout<<"   The subvector of each node contains those nodes to which we can go from the current node."<<endl;
                 cout<<"- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -\n"<<endl;
                 if(edgeList_was_computed==true){
+                    sync_edgeList();
                     for(int i=0; i<size; ++i){
                         cout<<"Node "<<i<<":";
-                        for(int j=0; j<edgeList[i].size(); ++j){
-                            cout<<" "<<edgeList[i][j].get_value1()<<"("<<edgeList[i][j].get_value2()<<")";
-                            if(j<edgeList[i].size()-1){
+                        for(int j=0; j<topology->edgeList[i].size(); ++j){
+                            cout<<" "<<topology->edgeList[i][j].get_value1()<<"("<<topology->edgeList[i][j].get_value2()<<")";
+                            if(j<topology->edgeList[i].size()-1){
                                 cout<<",";
                             }
                         }
@@ -418,7 +576,15 @@ namespace Graph{
                     cout<<"Connectivity matrix hadn't been computed yet, but it's now being generated."<<endl;
                     generate_conMatrix_from_edgeList();
                 }
-                return connectivityMatrix;
+                // (The matrix is stored flat, so the 2D copy is built here)
+                vector<vector<bool_and_num_Pair<numType>>> output(size);
+                for(int i=0; i<size && conMatrix_was_computed; ++i){
+                    output[i].reserve(size);
+                    for(int j=0; j<size; ++j){
+                        output[i].push_back(bool_and_num_Pair<numType>(matrix_get_bool(i,j), matrix_get_value(i,j)));
+                    }
+                }
+                return output;
             }
 
             vector<vector<int_and_num_Pair<numType>>> get_edgeList(){
@@ -426,12 +592,108 @@ namespace Graph{
                     cout<<"Edge list hadn't been computed yet, but it's now being generated."<<endl;
                     generate_edgeList_from_conMatrix();
                 }
-                return edgeList;
+                sync_edgeList();
+                return topology->edgeList;
+            }
+
+        protected:
+            // Access to the flat connectivity matrix (see the members below). No bounds checking:
+            // ===================================================================================
+            int matrix_row_words() const{ // Number of 64-bit words of each row of the adjacency bitmap
+                return (size+63)/64;
+            }
+
+            void conMatrix_allocate(){ // Allocates the whole matrix at once, with no edges and zero costs
+                detach_topology();
+                topology->adjacencyBits.assign(static_cast<size_t>(size)*matrix_row_words(), 0);
+                topology->edgeCosts.assign(static_cast<size_t>(size)*size, static_cast<numType>(0));
+                topology->matrix_n_edges = 0;
+                return;
+            }
+
+            bool matrix_get_bool(int nodeFrom, int nodeTo) const{
+                return (topology->adjacencyBits[static_cast<size_t>(nodeFrom)*matrix_row_words()+(nodeTo>>6)]>>(nodeTo&63))&1;
+            }
+
+            numType matrix_get_value(int nodeFrom, int nodeTo) const{
+                return topology->edgeCosts[static_cast<size_t>(nodeFrom)*size+nodeTo];
+            }
+
+            void matrix_set(int nodeFrom, int nodeTo, bool bool_value, numType num_value){
+                detach_topology();
+                uint64_t& word = topology->adjacencyBits[static_cast<size_t>(nodeFrom)*matrix_row_words()+(nodeTo>>6)];
+                uint64_t mask = static_cast<uint64_t>(1)<<(nodeTo&63);
+                if(((word&mask)!=0)!=bool_value){ // Keep the count of edges
+                    topology->matrix_n_edges += bool_value?1:-1;
+                }
+                word = bool_value?(word|mask):(word&~mask);
+                topology->edgeCosts[static_cast<size_t>(nodeFrom)*size+nodeTo] = num_value;
+                return;
+            }
+
+            void matrix_row_neighbors(int nodeFrom, vector<int_and_num_Pair<numType>>& output) const{
+                // Appends the nodes to which we can go from "nodeFrom" (and the costs) to output. Only
+                // the set bits of the row are visited: each word is consumed by count-trailing-zeros
+                int row_words = matrix_row_words();
+                const uint64_t* row = topology->adjacencyBits.data()+static_cast<size_t>(nodeFrom)*row_words;
+                for(int w=0; w<row_words; ++w){
+                    uint64_t bits = row[w];
+                    while(bits!=0){
+                        int j = (w<<6)+__builtin_ctzll(bits);
+                        output.push_back(int_and_num_Pair<numType>(j, matrix_get_value(nodeFrom,j)));
+                        bits &= bits-1; // Clear the lowest set bit
+                    }
+                }
+                return;
+            }
+
+            // Dirty tracking of the edge list:
+            // ================================
+            // When both representations exist, the edges are added, changed and deleted only in the
+            // matrix (O(1) each), and the rows of the edge list that they touch are just marked as
+            // dirty. A dirty row is rebuilt from the matrix when the list is needed, so mixed workloads
+            // neither update both representations nor rebuild the whole list.
+            void mark_edgeList_row_dirty(int node){
+                if(edgeList_was_computed==true && !topology->edgeList_row_is_dirty[node]){
+                    detach_topology();
+                    topology->edgeList_row_is_dirty[node] = true;
+                    topology->edgeList_dirty_rows.push_back(node);
+                }
+                return;
+            }
+
+            void sync_edgeList_row(int node){ // Brings one row of the edge list up to date
+                if(topology->edgeList_row_is_dirty.size()>0 && topology->edgeList_row_is_dirty[node]){
+                    detach_topology();
+                    topology->edgeList[node].clear();
+                    matrix_row_neighbors(node, topology->edgeList[node]);
+                    topology->edgeList_row_is_dirty[node] = false;
+                }
+                return;
+            }
+
+            void sync_edgeList(){ // Brings all of the dirty rows of the edge list up to date
+                for(int node : topology->edgeList_dirty_rows){
+                    sync_edgeList_row(node);
+                }
+                topology->edgeList_dirty_rows.clear();
+                return;
+            }
+
+            // Copy-on-write of the topology:
+            // ==============================
+            // Copies of a graph share the same Topology object. Every method which changes the edges
+            // calls detach_topology() first, so that the graph gets its own copy if it's shared. This
+            // way, the copies of a Hex_Board made by the bot only copy the node tags and values.
+            void detach_topology(){
+                if(topology.use_count()>1){
+                    topology = make_shared<Topology>(*topology);
+                }
+                return;
             }
 
         private: // These methods are needed in the copy constructor
-            vector<vector<bool_and_num_Pair<numType>>> private_getConMatrix() const{return connectivityMatrix;}
-            vector<vector<int_and_num_Pair<numType>>> private_getEdgeList() const{return edgeList;}
+            const shared_ptr<Topology>& private_getTopology() const{return topology;}
             representationMode get_preferredRepresentation() const{return preferredRepresentation;}
             vector<numType> get_nodeValues() const{return nodeValues;}
             vector<int> get_nodeTags() const{return nodeTags;}
@@ -441,18 +703,26 @@ namespace Graph{
         protected:
             // Common members for the derived classes:
             // =======================================
-            int const size;
-            vector<vector<bool_and_num_Pair<numType>>> connectivityMatrix; // Think of it as a 2D matrix. First dimension
-            // will be rows and second dimension will be columns
-            // This matrix will contain the connections AND ALSO THE VALUE OF THE COSTS.
-            // Connectivity matrix has to be interpreted as follows:
-            //      Row is "from" and column is "can go to". So the element (i,j), being i the row and
-            //      j the column, will be true if node i can go to node j and false otherwise.
-            vector<vector<int_and_num_Pair<numType>>> edgeList; // Think of it as a vector of vectors
-            // This list will contain the connections AND ALSO THE VALUE OF THE COSTS.
-            // Edge list has to be interpreted as follows:
-            //      This is a vector of vectors. It contains a subvector for each of the nodes.
-            //      The subvector of each node contains those nodes to which we can go from the current node.
+            int size;
+            struct Topology{ // The edges of the graph, in both representations
+                // The connectivity matrix. Think of it as a 2D matrix of size*size elements, rows being "from"
+                // and columns "can go to": the element (i,j) is true if node i can go to node j and false
+                // otherwise, and it also has the value of the cost. It's stored flat, in two row-major arrays
+                // allocated at once (so copying the matrix is a plain copy of two blocks of memory):
+                vector<uint64_t> adjacencyBits; // The connections, one bit per element. Each row takes
+                // matrix_row_words() words, and element (i,j) is bit j%64 of word i*matrix_row_words()+j/64
+                vector<numType> edgeCosts; // The costs. Element (i,j) is edgeCosts[i*size+j]
+                long matrix_n_edges = 0; // Number of true elements of the matrix (kept up to date by matrix_set)
+                vector<vector<int_and_num_Pair<numType>>> edgeList; // Think of it as a vector of vectors
+                // This list will contain the connections AND ALSO THE VALUE OF THE COSTS.
+                // Edge list has to be interpreted as follows:
+                //      This is a vector of vectors. It contains a subvector for each of the nodes.
+                //      The subvector of each node contains those nodes to which we can go from the current node.
+                vector<int> edgeList_dirty_rows; // Rows of the edge list which are out of date with the matrix
+                vector<bool> edgeList_row_is_dirty; // (See mark_edgeList_row_dirty)
+            };
+            shared_ptr<Topology> topology; // Shared between the copies of a graph until one of them changes
+            // its edges (copy-on-write, see detach_topology), so copying a graph only copies its nodes
             representationMode preferredRepresentation;
             vector<numType> nodeValues; // A vector containing the values assigned to the nodes
             vector<int> nodeTags; // A vector containing int tags for the nodes, in case they are needed
@@ -472,7 +742,7 @@ namespace Graph{
             // nor the edge list). The parameter "dummy" is needed just to have a different signature for this
             // special constructor
             undirected_Graph(int size, string dummy, representationMode mode=CON_MATRIX):\
-            Graph<numType>(size,mode),density(0){
+            Graph<numType>(size,mode),density(0),generator_threads(1){
                 // Don't generate the connectivity matrix nor the edge list (as required
                 // by the derived class Hex_Board)
                 
@@ -486,7 +756,7 @@ namespace Graph{
             // Constructors (standard and with parameters):
             // ============================================
             // Standard constructor. Construct a graph of size 5 and density 1.0
-            undirected_Graph():Graph<numType>(5,CON_MATRIX),density(1.0){
+            undirected_Graph():Graph<numType>(5,CON_MATRIX),density(1.0),generator_threads(1){
                 // Generate the connectivity matrix or the edge list:
                 if(this->preferredRepresentation==CON_MATRIX){generate_graph_matrixMode();}
                 else{generate_graph_edgeListMode();}
@@ -496,8 +766,10 @@ namespace Graph{
                 for(int i=0; i<this->size; ++i){this->nodeTags.push_back(0);}
             }
             // Size and density as parameters. Default value for density if not given
-            undirected_Graph(int size, float density=1.0, representationMode mode=CON_MATRIX):\
-            Graph<numType>(size,mode),density((density>=0 && density<=1.0)?density:1.0){
+            // (In EDGE_LIST mode, the random edges can be drawn by several threads, see generate_graph_edgeListMode)
+            undirected_Graph(int size, float density=1.0, representationMode mode=CON_MATRIX, int generator_threads=1):\
+            Graph<numType>(size,mode),density((density>=0 && density<=1.0)?density:1.0),\
+            generator_threads((generator_threads>0)?generator_threads:1){
                 // Generate the connectivity matrix or the edge list:
                 if(this->preferredRepresentation==CON_MATRIX){generate_graph_matrixMode();}
                 else{generate_graph_edgeListMode();}
@@ -507,9 +779,9 @@ namespace Graph{
                 for(int i=0; i<this->size; ++i){this->nodeTags.push_back(0);}
             }
             // Node values and density as parameters. Default density if not given
-            undirected_Graph(vector<numType> nodeValues, float density=1.0, representationMode mode=CON_MATRIX):\
-            Graph<numType>(nodeValues.size(),mode,nodeValues),\
-            density((density>=0 && density<=1.0)?density:1.0){
+            undirected_Graph(vector<numType> nodeValues, float density=1.0, representationMode mode=CON_MATRIX,\
+            int generator_threads=1):Graph<numType>(nodeValues.size(),mode,nodeValues),\
+            density((density>=0 && density<=1.0)?density:1.0),generator_threads((generator_threads>0)?generator_threads:1){
                 // Generate the connectivity matrix or the edge list:
                 if(this->preferredRepresentation==CON_MATRIX){generate_graph_matrixMode();}
                 else{generate_graph_edgeListMode();}
@@ -518,7 +790,13 @@ namespace Graph{
             }
 
             // Copy constructor:
-            undirected_Graph(const undirected_Graph<numType>& sample):Graph<numType>(sample),density(sample.get_density()){}
+            undirected_Graph(const undirected_Graph<numType>& sample):Graph<numType>(sample),density(sample.get_density()),\
+            generator_threads(sample.get_generator_threads()){}
+
+            // Move constructor and assignments (see Graph, the topology is shared or moved):
+            undirected_Graph(undirected_Graph<numType>&& sample) = default;
+            undirected_Graph<numType>& operator=(const undirected_Graph<numType>& sample) = default;
+            undirected_Graph<numType>& operator=(undirected_Graph<numType>&& sample) = default;
 
             // Class methods:
             // ==============
@@ -530,27 +808,15 @@ namespace Graph{
                 bool boolAux;
                 double doubleAux;
                 numType costAux;
+                this->conMatrix_allocate(); // No edges at first (so i==j is skipped, to avoid connecting a node with itself)
                 for(int i=0; i<this->size; ++i){ // Iterating rows
-                    this->connectivityMatrix.push_back(vector<bool_and_num_Pair<numType>>());
-                    for(int j=0; j<this->size; ++j){ // Iterating columns
-                        if(i<j){
-                            doubleAux = probability_having_edge(gen);
-                            boolAux = (doubleAux<density);
-                            if(boolAux==true){
-                                costAux = static_cast<numType>(cost_value(gen));
-                            }else{
-                                costAux = 0;
-                            }
-                            this->connectivityMatrix[i].push_back(bool_and_num_Pair(boolAux, costAux));
-
-                        }else if(i==j){ // Skip i==j, to avoid connecting a node with itself
-                            boolAux = false;
-                            costAux = 0;
-                            this->connectivityMatrix[i].push_back(bool_and_num_Pair(boolAux, costAux));
-                        }else{ // Undirected graph, so the matrix has to be symmetric
-                            boolAux = this->connectivityMatrix[j][i].get_bool();
-                            costAux = this->connectivityMatrix[j][i].get_value();
-                            this->connectivityMatrix[i].push_back(bool_and_num_Pair(boolAux, costAux));
+                    for(int j=i+1; j<this->size; ++j){ // Iterating columns
+                        doubleAux = probability_having_edge(gen);
+                        boolAux = (doubleAux<density);
+                        if(boolAux==true){
+                            costAux = static_cast<numType>(cost_value(gen));
+                            this->matrix_set(i, j, true, costAux);
+                            this->matrix_set(j, i, true, costAux); // Undirected graph, so the matrix has to be symmetric
                         }
                     }
                 }
@@ -562,31 +828,96 @@ namespace Graph{
             virtual void generate_graph_edgeListMode(){
                 // This method has to take into account the symmetry too. If node
                 // x has node y in its list, node y has to have node x too.
-                // To do that, the most efficient way is to build directly the
-                // connectivity matrix and then compute the edge list from the matrix
-                generate_graph_matrixMode();
-                this->generate_edgeList_from_conMatrix();
+                // The edge list is built directly, without the connectivity matrix, so that the work is
+                // proportional to the number of edges and not to size^2 (see generate_rows_geometric).
+                // Row v only draws the edges (v,w) with w<v, and each edge is then added to both nodes.
+                // With generator_threads>1, the rows are split into blocks of about the same number of
+                // pairs, and each block is drawn by its own thread with its own random stream.
+                if(this->edgeList_was_computed==true){
+                    cout<<"Edge list is already computed. Nothing new has been done."<<endl;
+                    return;
+                }
+                vector<vector<int_int_and_num_Triad<numType>>> blocks(generator_threads);
+                uint64_t base_seed = gen(); // (So that the graphs still depend on the global generator)
+                if(generator_threads==1){
+                    generate_rows_geometric(0, this->size, base_seed, blocks[0]);
+                }else{
+                    vector<thread> workers;
+                    for(int t=0; t<generator_threads; ++t){
+                        // Row v has v pairs, so the first t/T of the pairs end at row size*sqrt(t/T):
+                        int first_row = static_cast<int>(this->size*sqrt(static_cast<double>(t)/generator_threads));
+                        int end_row = static_cast<int>(this->size*sqrt(static_cast<double>(t+1)/generator_threads));
+                        if(t==generator_threads-1){end_row = this->size;}
+                        workers.push_back(thread(&undirected_Graph<numType>::generate_rows_geometric, this,\
+                        first_row, end_row, base_seed+t, ref(blocks[t])));
+                    }
+                    for(thread& worker : workers){
+                        worker.join();
+                    }
+                }
+                this->edgeList_destruction();
+                this->topology->edgeList.resize(this->size);
+                for(auto& block : blocks){
+                    for(auto& edge : block){
+                        this->topology->edgeList[edge.get_value1()].push_back(int_and_num_Pair<numType>(edge.get_value2(), edge.get_value3()));
+                        this->topology->edgeList[edge.get_value2()].push_back(int_and_num_Pair<numType>(edge.get_value1(), edge.get_value3()));
+                    }
+                }
+                this->topology->edgeList_row_is_dirty.assign(this->size, false);
                 cout<<"Edge list has been generated."<<endl;
                 this->edgeList_was_computed = true;
                 return;
             }
 
+            void generate_rows_geometric(int first_row, int end_row, uint64_t seed,\
+            vector<int_int_and_num_Triad<numType>>& output) const{
+                // Draws the random edges (v,w), w<v, of the rows v in [first_row, end_row), by geometric
+                // skipping (Batagelj & Brandes, 2005): instead of one random number per pair, the gap to
+                // the next edge is drawn directly, as it follows a geometric distribution of parameter
+                // "density". The result has the same distribution as testing each pair, in O(edges) time.
+                mt19937_64 engine(seed);
+                uniform_real_distribution<double> uniform(0.0, 1.0);
+                uniform_real_distribution<double> cost_distribution(0.0, 10.0); // (Same costs as cost_value)
+                if(density<=0){
+                    return;
+                }
+                double log_no_edge = (density<1.0)?log(1.0-density):0.0;
+                for(int v=first_row; v<end_row; ++v){
+                    double w = -1; // (A double, as the gaps can be huge for very low densities)
+                    while(true){
+                        double skip = 0;
+                        if(density<1.0){
+                            skip = floor(log(1.0-uniform(engine))/log_no_edge);
+                        }
+                        w += 1+skip;
+                        if(w>=v){
+                            break;
+                        }
+                        output.push_back(int_int_and_num_Triad<numType>(v, static_cast<int>(w),\
+                        static_cast<numType>(cost_distribution(engine))));
+                    }
+                }
+                return;
+            }
+
             void force_set_edge_value(int nodeFrom, int nodeTo, numType val){ // Sets (OVERRIDING it!!) the cost of the edge from nodeFrom
             // to nodeTo to val if the edge already exists. If it doesn't exist, the edge is added.
             // This method has to take into account the symmetry too!
-                if(this->edgeList_was_computed==true){
+                if(this->conMatrix_was_computed==false && this->edgeList_was_computed==true){ // (If there's a
+                    // matrix, the list is only marked as dirty, see Graph::mark_edgeList_row_dirty)
+                    this->detach_topology();
                     // Check if the edge already exists and if so, impose the new value.
                     // If it doesn't exist, add the new edge and its value.
                     bool alreadyExists = false;
-                    for(int j=0; j<this->edgeList[nodeFrom].size(); ++j){
-                        if(this->edgeList[nodeFrom][j].get_value1()==nodeTo){
+                    for(int j=0; j<this->topology->edgeList[nodeFrom].size(); ++j){
+                        if(this->topology->edgeList[nodeFrom][j].get_value1()==nodeTo){
                             alreadyExists = true;
-                            this->edgeList[nodeFrom][j].set_value2(val);
+                            this->topology->edgeList[nodeFrom][j].set_value2(val);
 
                             // And now, set the symmetric edge:
-                            for(int k=0; k<this->edgeList[nodeTo].size(); ++k){
-                                if(this->edgeList[nodeTo][k].get_value1()==nodeFrom){
-                                    this->edgeList[nodeTo][k].set_value2(val);
+                            for(int k=0; k<this->topology->edgeList[nodeTo].size(); ++k){
+                                if(this->topology->edgeList[nodeTo][k].get_value1()==nodeFrom){
+                                    this->topology->edgeList[nodeTo][k].set_value2(val);
                                     break;
                                 }
                             }
@@ -595,46 +926,48 @@ namespace Graph{
                         }
                     }
                     if(alreadyExists==false){
-                        this->edgeList[nodeFrom].push_back(int_and_num_Pair(nodeTo, val));
+                        this->topology->edgeList[nodeFrom].push_back(int_and_num_Pair(nodeTo, val));
                         // And now, set the symmetric edge:
-                        this->edgeList[nodeTo].push_back(int_and_num_Pair(nodeFrom, val));
+                        this->topology->edgeList[nodeTo].push_back(int_and_num_Pair(nodeFrom, val));
                     }
                 }
                 if(this->conMatrix_was_computed==true){
-                    this->connectivityMatrix[nodeFrom][nodeTo].set_bool(true);
-                    this->connectivityMatrix[nodeFrom][nodeTo].set_value(val);
+                    this->matrix_set(nodeFrom, nodeTo, true, val);
                     // And now, set the symmetric edge:
-                    this->connectivityMatrix[nodeTo][nodeFrom].set_bool(true);
-                    this->connectivityMatrix[nodeTo][nodeFrom].set_value(val);
+                    this->matrix_set(nodeTo, nodeFrom, true, val);
+                    this->mark_edgeList_row_dirty(nodeFrom);
+                    this->mark_edgeList_row_dirty(nodeTo);
                 }
                 return;
             }
 
             void addEdge(int nodeFrom, int nodeTo, numType cost){ // Adds an edge (if it doesn't exist yet) and adds its cost
             // This method has to take into account the symmetry too!
-                if(this->edgeList_was_computed==true){
+                if(this->conMatrix_was_computed==false && this->edgeList_was_computed==true){ // (If there's a
+                    // matrix, the list is only marked as dirty, see Graph::mark_edgeList_row_dirty)
+                    this->detach_topology();
                     // Add the new edge and its cost ONLY IF THE EDGE DOESN'T EXIST YET.
                     bool alreadyExists = false;
-                    for(int j=0; j<this->edgeList[nodeFrom].size(); ++j){
-                        if(this->edgeList[nodeFrom][j].get_value1()==nodeTo){
+                    for(int j=0; j<this->topology->edgeList[nodeFrom].size(); ++j){
+                        if(this->topology->edgeList[nodeFrom][j].get_value1()==nodeTo){
                             alreadyExists = true;
                             break;
                         }
                     }
                     if(alreadyExists==false){
-                        this->edgeList[nodeFrom].push_back(int_and_num_Pair(nodeTo, cost));
+                        this->topology->edgeList[nodeFrom].push_back(int_and_num_Pair(nodeTo, cost));
                         // And now, set the symmetric edge:
-                        this->edgeList[nodeTo].push_back(int_and_num_Pair(nodeFrom, cost));
+                        this->topology->edgeList[nodeTo].push_back(int_and_num_Pair(nodeFrom, cost));
                     }
                 }
                 if(this->conMatrix_was_computed==true){
                     // Add the new edge and its cost ONLY IF THE EDGE DOESN'T EXIST YET.
-                    if(this->connectivityMatrix[nodeFrom][nodeTo].get_bool()==false){
-                        this->connectivityMatrix[nodeFrom][nodeTo].set_bool(true);
-                        this->connectivityMatrix[nodeFrom][nodeTo].set_value(cost);
+                    if(this->matrix_get_bool(nodeFrom,nodeTo)==false){
+                        this->matrix_set(nodeFrom, nodeTo, true, cost);
                         // And now, set the symmetric edge:
-                        this->connectivityMatrix[nodeTo][nodeFrom].set_bool(true);
-                        this->connectivityMatrix[nodeTo][nodeFrom].set_value(cost);
+                        this->matrix_set(nodeTo, nodeFrom, true, cost);
+                        this->mark_edgeList_row_dirty(nodeFrom);
+                        this->mark_edgeList_row_dirty(nodeTo);
                     }
                 }
                 return;
@@ -642,21 +975,23 @@ namespace Graph{
 
             void deleteEdge(int nodeFrom, int nodeTo){ // Removes the edge from nodeFrom to nodeTo, if it exists
             // This method has to take into account the symmetry too!
-                if(this->edgeList_was_computed==true){
+                if(this->conMatrix_was_computed==false && this->edgeList_was_computed==true){ // (If there's a
+                    // matrix, the list is only marked as dirty, see Graph::mark_edgeList_row_dirty)
+                    this->detach_topology();
                     // Delete the edge if it is found.
                     bool found = false;
-                    for(int j=0; j<this->edgeList[nodeFrom].size(); ++j){
-                        if(this->edgeList[nodeFrom][j].get_value1()==nodeTo){
+                    for(int j=0; j<this->topology->edgeList[nodeFrom].size(); ++j){
+                        if(this->topology->edgeList[nodeFrom][j].get_value1()==nodeTo){
                             found = true;
-                            this->edgeList[nodeFrom].erase(this->edgeList[nodeFrom].begin()+j);
+                            this->topology->edgeList[nodeFrom].erase(this->topology->edgeList[nodeFrom].begin()+j);
                                 // https://cplusplus.com/reference/vector/vector/erase/
                                 // (vector.erase(vector.begin()+n) removes the element with index n and relocates memory)
                                 // (vector.erase(vector.begin()+ini, vector.begin()+fin) removes the elements with indices in the range [ini,fin) and relocates memory)
                             
                             // And now, erase the symmetric edge:
-                            for(int k=0; k<this->edgeList[nodeTo].size(); ++k){
-                                if(this->edgeList[nodeTo][k].get_value1()==nodeFrom){
-                                    this->edgeList[nodeTo].erase(this->edgeList[nodeTo].begin()+k);
+                            for(int k=0; k<this->topology->edgeList[nodeTo].size(); ++k){
+                                if(this->topology->edgeList[nodeTo][k].get_value1()==nodeFrom){
+                                    this->topology->edgeList[nodeTo].erase(this->topology->edgeList[nodeTo].begin()+k);
                                     break;
                                 }
                             }
@@ -667,12 +1002,12 @@ namespace Graph{
                 }
                 if(this->conMatrix_was_computed==true){
                     // Delete the edge if it is found.
-                    if(this->connectivityMatrix[nodeFrom][nodeTo].get_bool()==true){
-                        this->connectivityMatrix[nodeFrom][nodeTo].set_bool(false);
-                        this->connectivityMatrix[nodeFrom][nodeTo].set_value(0);
+                    if(this->matrix_get_bool(nodeFrom,nodeTo)==true){
+                        this->matrix_set(nodeFrom, nodeTo, false, 0);
                         // And now, delete the symmetric edge:
-                        this->connectivityMatrix[nodeTo][nodeFrom].set_bool(false);
-                        this->connectivityMatrix[nodeTo][nodeFrom].set_value(0);
+                        this->matrix_set(nodeTo, nodeFrom, false, 0);
+                        this->mark_edgeList_row_dirty(nodeFrom);
+                        this->mark_edgeList_row_dirty(nodeTo);
                     }
                 }
                 return;
@@ -682,8 +1017,216 @@ namespace Graph{
                 return this->density;
             }
 
+            int get_generator_threads() const{
+                return this->generator_threads;
+            }
+
+        private:
+            float density;
+            int generator_threads; // Threads used to draw the random edges in EDGE_LIST mode
+    };
+
+    // ===============================================================================================
+    // class Board_Tables
+    // ===============================================================================================
+    class Board_Tables{
+        // The neighbors and the borders of the Hex boards, generated at compile time and embedded in the
+        // binary for the border lengths MIN_ENGINE_BORDER_LENGTH to MAX_ENGINE_BORDER_LENGTH (other sizes
+        // are computed at runtime with the same constexpr function). The node of (x,y) is x*N+y, and the
+        // six directions d are, as (dx,dy):
+        //      0: (-1,0)   1: (-1,1)   2: (0,-1)   3: (0,1)   4: (1,-1)   5: (1,0)
+        // so that the opposite of direction d is 5-d.
+
+        public:
+            static int const N_DIRECTIONS = 6;
+
+            static constexpr int neighbor(int border_length, int node, int d){ // The neighbor of node in direction
+            // d, or -1 if it's outside the board. This is the only place where corners and borders are told apart
+                int const dx[N_DIRECTIONS] = {-1, -1, 0, 0, 1, 1};
+                int const dy[N_DIRECTIONS] = {0, 1, -1, 1, -1, 0};
+                int x = node/border_length+dx[d];
+                int y = node%border_length+dy[d];
+                if(x<0 || x>=border_length || y<0 || y>=border_length){
+                    return -1;
+                }
+                return x*border_length+y;
+            }
+
+            template<int N>
+            struct Of{ // The tables of the boards of border length N
+                static constexpr int SIZE = N*N;
+                static constexpr int WORDS = (SIZE+63)/64; // Width of a bitboard (bit x*N+y) in 64-bit words
+                typedef array<uint64_t, WORDS> Bitboard;
+
+                static constexpr array<int, N_DIRECTIONS*SIZE> make_neighbors(){
+                    array<int, N_DIRECTIONS*SIZE> table{};
+                    for(int node=0; node<SIZE; ++node){
+                        for(int d=0; d<N_DIRECTIONS; ++d){
+                            table[node*N_DIRECTIONS+d] = neighbor(N, node, d);
+                        }
+                    }
+                    return table;
+                }
+
+                static constexpr Bitboard line_mask(bool is_row, int index){ // Bits of a row (x==index) or a column (y==index)
+                    Bitboard mask{};
+                    for(int node=0; node<SIZE; ++node){
+                        if((is_row?(node/N):(node%N))==index){
+                            mask[node>>6] |= static_cast<uint64_t>(1)<<(node&63);
+                        }
+                    }
+                    return mask;
+                }
+
+                static constexpr array<int, N_DIRECTIONS*SIZE> NEIGHBORS = make_neighbors(); // NEIGHBORS[node*6+d]
+                static constexpr Bitboard NORTH = line_mask(true, 0); // Borders of player 1
+                static constexpr Bitboard SOUTH = line_mask(true, N-1);
+                static constexpr Bitboard WEST = line_mask(false, 0); // Borders of player 2
+                static constexpr Bitboard EAST = line_mask(false, N-1);
+            };
+
+            template<int N>
+            static constexpr bool tables_are_valid(){ // Checked at compile time for every embedded size: each
+            // neighbor sees the node back in the opposite direction, the corners, borders and inner cells
+            // have 2 or 3, 4 and 6 neighbors, and the four border masks have exactly the cells of their row or column
+                for(int node=0; node<N*N; ++node){
+                    int x = node/N;
+                    int y = node%N;
+                    int count = 0;
+                    for(int d=0; d<N_DIRECTIONS; ++d){
+                        int next = Of<N>::NEIGHBORS[node*N_DIRECTIONS+d];
+                        if(next>=0){
+                            ++count;
+                            if(Of<N>::NEIGHBORS[next*N_DIRECTIONS+N_DIRECTIONS-1-d]!=node){
+                                return false;
+                            }
+                        }
+                    }
+                    int on_borders = (x==0 || x==N-1)+(y==0 || y==N-1);
+                    int expected = (on_borders==0)?6:(on_borders==1)?4:((x==y)?2:3);
+                    if(count!=expected){
+                        return false;
+                    }
+                    bool north = (Of<N>::NORTH[node>>6]>>(node&63))&1;
+                    bool south = (Of<N>::SOUTH[node>>6]>>(node&63))&1;
+                    bool west = (Of<N>::WEST[node>>6]>>(node&63))&1;
+                    bool east = (Of<N>::EAST[node>>6]>>(node&63))&1;
+                    if(north!=(x==0) || south!=(x==N-1) || west!=(y==0) || east!=(y==N-1)){
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            static const int* embedded_neighbors(int border_length){ // The embedded NEIGHBORS of border_length,
+            // or nullptr if that size isn't embedded
+                static const array<const int*, MAX_ENGINE_BORDER_LENGTH+1> tables =\
+                make_pointers(make_integer_sequence<int, MAX_ENGINE_BORDER_LENGTH-MIN_ENGINE_BORDER_LENGTH+1>());
+                if(border_length<MIN_ENGINE_BORDER_LENGTH || border_length>MAX_ENGINE_BORDER_LENGTH){
+                    return nullptr;
+                }
+                return tables[border_length];
+            }
+
+            template<typename neighborCallback>
+            static void for_each_neighbor_pair(int border_length, neighborCallback callback){ // Calls
+            // callback(node, d, neighbor) for every cell of the board and every direction d inside the board
+                const int* table = embedded_neighbors(border_length);
+                for(int node=0; node<border_length*border_length; ++node){
+                    for(int d=0; d<N_DIRECTIONS; ++d){
+                        int next = (table!=nullptr)?table[node*N_DIRECTIONS+d]:neighbor(border_length, node, d);
+                        if(next>=0){
+                            callback(node, d, next);
+                        }
+                    }
+                }
+                return;
+            }
+
+        private:
+            template<int... K>
+            static array<const int*, MAX_ENGINE_BORDER_LENGTH+1> make_pointers(integer_sequence<int, K...>){
+                static_assert((tables_are_valid<MIN_ENGINE_BORDER_LENGTH+K>() && ...), "Inconsistent Hex board tables");
+                array<const int*, MAX_ENGINE_BORDER_LENGTH+1> pointers{};
+                ((pointers[MIN_ENGINE_BORDER_LENGTH+K] = Of<MIN_ENGINE_BORDER_LENGTH+K>::NEIGHBORS.data()), ...);
+                return pointers;
+            }
+    };
+
+    // ===============================================================================================
+    // class Heatmap
+    // ===============================================================================================
+    class Heatmap{
+        // The ratios of victories that the Monte Carlo engine has computed for the candidate moves of a
+        // position (the nodes_and_ratios of MonteCarlo_Bot), by node, so that they can be kept after the
+        // move has been chosen: to be drawn over the board (see Hex_Board::draw_board_ASCII) or read
+        // with get_ratio(). Nodes which weren't candidates have no ratio.
+        // On the board, each candidate is drawn as its ratio x 10 (0 to 9), coloured with ANSI codes:
+        // red below 1/3, yellow below 2/3 and green above, and the best candidate (or the chosen move, see
+        // set_best_node()) in bold.
+
+        public:
+            Heatmap(int n_nodes=0, int player=2):ratios(n_nodes, -1),player(player),best_node(-1){}
+
+            Heatmap(int n_nodes, const vector<pair<int, double>>& nodes_and_ratios, int player=2):\
+            ratios(n_nodes, -1),player(player),best_node(-1){
+                for(auto& candidate : nodes_and_ratios){
+                    set_ratio(candidate.first, candidate.second);
+                }
+            }
+
+            void set_ratio(int node, double ratio){
+                ratios[node] = ratio;
+                if(best_node<0 || ratio>ratios[best_node]){
+                    best_node = node;
+                }
+                return;
+            }
+
+            bool has_ratio(int node) const{
+                return node>=0 && node<V() && ratios[node]>=0;
+            }
+
+            double get_ratio(int node) const{ // -1 if node wasn't a candidate
+                return ratios[node];
+            }
+
+            int get_best_node() const{ // -1 if there are no candidates
+                return best_node;
+            }
+
+            void set_best_node(int node){ // The move which was chosen, if it isn't the best ratio (e.g. with
+            // sequential halving, where a candidate dropped early may have a higher ratio from fewer games)
+                if(has_ratio(node)){
+                    best_node = node;
+                }
+                return;
+            }
+
+            int get_player() const{ // The player whose ratios of victories these are
+                return player;
+            }
+
+            int V() const{
+                return ratios.size();
+            }
+
+            string cell(int node) const{ // How node is drawn on the board (only for candidates)
+                int digit = min(9, static_cast<int>(ratios[node]*10));
+                string colour = (ratios[node]<1.0/3)?"31":((ratios[node]<2.0/3)?"33":"32");
+                string style = (node==best_node)?"1;":"";
+                return "\033["+style+colour+"m"+to_string(digit)+"\033[0m";
+            }
+
+            string legend() const{
+                return "Heatmap of player "+to_string(player)+": ratio of victories x 10 of each move "+\
+                "(\033[31mlow\033[0m, \033[33mmedium\033[0m, \033[32mhigh\033[0m, chosen move in bold)";
+            }
+
         private:
-            float const density;
+            vector<double> ratios; // By node
+            int player;
+            int best_node;
     };
 
     // ===============================================================================================
@@ -729,6 +1272,12 @@ namespace Graph{
             // Copy constructor:
             Hex_Board(const Hex_Board& sample):undirected_Graph<int>(sample),border_length(sample.get_border_length()){}
 
+            // Move constructor and assignments. Copying a board shares its topology (which never changes
+            // while playing), so only the stones (node tags) and node values are actually copied:
+            Hex_Board(Hex_Board&& sample) = default;
+            Hex_Board& operator=(const Hex_Board& sample) = default;
+            Hex_Board& operator=(Hex_Board&& sample) = default;
+
             // Class specific methods:
             // =======================
             void generate_blank_connected_board(){ // Generates a blank and connected Hex board graph
@@ -745,136 +1294,23 @@ namespace Graph{
                     cout<<"Connectivity matrix is already computed. Nothing new has been done."<<endl;
                     return;
                 }
-                
-                // First initialize a connectivity matrix of zeros:
-                for(int i=0; i<this->size; ++i){ // Iterating rows
-                    this->connectivityMatrix.push_back(vector<bool_and_num_Pair<int>>());
-                    for(int j=0; j<this->size; ++j){
-                        this->connectivityMatrix[i].push_back(bool_and_num_Pair(false, 0));
-                    }
-                }
-
-                int cost = 1;
-                for(int node=0; node<this->size; ++node){
-                    pair<int,int> node_coords = nodeIndex_to_coordinate(node);
-                    int x = node_coords.first;
-                    int y = node_coords.second;
-                    int temp_nodeFrom;
-
-                    if(x==0 && y==0){ // Top left corner
-                        // Connect to node (x*border_length + y+1):
-                        temp_nodeFrom = x*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y):
-                        temp_nodeFrom = (x+1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        
-                    }else if(x==border_length-1 && y==border_length-1){ // Bottom right corner
-                        // Connect to node ((x-1)*border_length + y):
-                        temp_nodeFrom = (x-1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node (x*border_length + y-1):
-                        temp_nodeFrom = x*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        
-                    }else if(x==border_length-1 && y==0){ // Bottom left corner
-                        // Connect to node ((x-1)*border_length + y):
-                        temp_nodeFrom = (x-1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x-1)*border_length + y+1):
-                        temp_nodeFrom = (x-1)*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node (x*border_length + y+1):
-                        temp_nodeFrom = x*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        
-                    }else if(x==0 && y==border_length-1){ // Top right corner
-                        // Connect to node (x*border_length + y-1):
-                        temp_nodeFrom = x*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y-1):
-                        temp_nodeFrom = (x+1)*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y):
-                        temp_nodeFrom = (x+1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        
-                    }else if(x==0){ // Inner top
-                        // Connect to node (x*border_length + y-1):
-                        temp_nodeFrom = x*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node (x*border_length + y+1):
-                        temp_nodeFrom = x*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y-1):
-                        temp_nodeFrom = (x+1)*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y):
-                        temp_nodeFrom = (x+1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        
-                    }else if(x==border_length-1){ // Inner bottom
-                        // Connect to node ((x-1)*border_length + y):
-                        temp_nodeFrom = (x-1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x-1)*border_length + y+1):
-                        temp_nodeFrom = (x-1)*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node (x*border_length + y-1):
-                        temp_nodeFrom = x*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node (x*border_length + y+1):
-                        temp_nodeFrom = x*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        
-                    }else if(y==0){ // Inner left
-                        // Connect to node ((x-1)*border_length + y):
-                        temp_nodeFrom = (x-1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x-1)*border_length + y+1):
-                        temp_nodeFrom = (x-1)*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node (x*border_length + y+1):
-                        temp_nodeFrom = x*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y):
-                        temp_nodeFrom = (x+1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        
-                    }else if(y==border_length-1){ // Inner right
-                        // Connect to node ((x-1)*border_length + y):
-                        temp_nodeFrom = (x-1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node (x*border_length + y-1):
-                        temp_nodeFrom = x*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y-1):
-                        temp_nodeFrom = (x+1)*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y):
-                        temp_nodeFrom = (x+1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        
-                    }else{ // General inner node
-                        // Connect to node ((x-1)*border_length + y):
-                        temp_nodeFrom = (x-1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x-1)*border_length + y+1):
-                        temp_nodeFrom = (x-1)*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node (x*border_length + y-1):
-                        temp_nodeFrom = x*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node (x*border_length + y+1):
-                        temp_nodeFrom = x*border_length + y+1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y-1):
-                        temp_nodeFrom = (x+1)*border_length + y-1;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                        // Connect to node ((x+1)*border_length + y):
-                        temp_nodeFrom = (x+1)*border_length + y;
-                        this->connectivityMatrix[temp_nodeFrom][node].set_pair(true,cost);
-                    }
+
+                // Every blank board of a size has the same matrix, so it's generated only once (from the
+                // neighbor table, see Board_Tables) and then shared by all of the boards of that size. A
+                // board gets its own copy only if its edges are changed (see Graph::detach_topology)
+                static unordered_map<int, shared_ptr<Topology>> blank_topologies;
+                static mutex blank_topologies_mutex;
+                lock_guard<mutex> lock(blank_topologies_mutex);
+                shared_ptr<Topology>& blank = blank_topologies[border_length];
+                if(blank==nullptr){
+                    this->conMatrix_allocate();
+                    int cost = 1;
+                    Board_Tables::for_each_neighbor_pair(border_length, [&](int node, int, int neighbor){
+                        this->matrix_set(neighbor, node, true, cost);
+                    });
+                    blank = this->topology;
+                }else{
+                    this->topology = blank;
                 }
 
                 cout<<"Connectivity matrix has been generated."<<endl;
@@ -891,7 +1327,8 @@ namespace Graph{
                 return;
             }
 
-            void draw_board_ASCII(bool clear_screen_previously = true){ // Draws the board (in its current status) in ASCII characters
+            void draw_board_ASCII(bool clear_screen_previously = true, const Heatmap* heatmap = nullptr){ // Draws the
+            // board (in its current status) in ASCII characters. With a heatmap, its ratios are drawn on the empty cells
             //       x   x   x   x   x
             //       0   1   2  ... 10
             //  o 0  . - . - . - . - .  0 o
@@ -931,6 +1368,8 @@ namespace Graph{
                         cout<<"X - ";
                     }else if(aux==2){
                         cout<<"O - ";
+                    }else if(heatmap!=nullptr && heatmap->has_ratio(coordinate_to_nodeIndex(x,y))){
+                        cout<<heatmap->cell(coordinate_to_nodeIndex(x,y))<<" - ";
                     }else{
                         cout<<". - ";
                     }
@@ -940,6 +1379,8 @@ namespace Graph{
                     cout<<"X";
                 }else if(aux==2){
                     cout<<"O";
+                }else if(heatmap!=nullptr && heatmap->has_ratio(coordinate_to_nodeIndex(x,border_length-1))){
+                    cout<<heatmap->cell(coordinate_to_nodeIndex(x,border_length-1));
                 }else{
                     cout<<".";
                 }
@@ -962,6 +1403,9 @@ namespace Graph{
                     cout<<"x"<<endl;
                 }
             }
+            if(heatmap!=nullptr){
+                cout<<heatmap->legend()<<endl;
+            }
             return; 
             }
 
@@ -1031,541 +1475,4178 @@ namespace Graph{
     };
    
     // ===============================================================================================
-    // class PriorityQueue
+    // class BoardTopology
     // ===============================================================================================
-    template<typename numType>
-    class PriorityQueue{
-        public:
-            PriorityQueue(){} // Default constructor
-
-            ~PriorityQueue(){queue.clear();} // Destructor
-        
-        void change_Prioirity(int index, int new_position){ // Changes the priority of queue element
-            int_int_and_num_Triad<numType> temp;
-            temp = queue[index];
-            queue.erase(queue.begin()+index);
-            queue.insert(queue.begin()+new_position, temp);
-            return;
-        }
+    class BoardTopology{
+        // The fixed part of an Hex board of a given border length: the neighbors of each cell, the
+        // coordinates of each node and the borders of each player. It's the same for every game of that
+        // size, so it's built only once per border length and shared (see of()). The stones of a game
+        // are kept apart, in a Position.
 
-        bool contains(int_int_and_num_Triad<numType> queue_element){ // Does the queue contain queue_element
-            for(int i=0; i<queue.size(); ++i){
-                if(queue[i].get_value1()==queue_element.get_value1() \
-                && queue[i].get_value2()==queue_element.get_value2() \
-                && queue[i].get_value3()==queue_element.get_value3()){
-                    return true;
+        public:
+            static const BoardTopology& of(int border_length){ // The topology of the boards of border_length
+                static unordered_map<int, unique_ptr<BoardTopology>> topologies;
+                static mutex topologies_mutex; // (The bot may look them up from several threads)
+                lock_guard<mutex> lock(topologies_mutex);
+                unique_ptr<BoardTopology>& topology = topologies[border_length];
+                if(topology==nullptr){
+                    topology.reset(new BoardTopology(border_length));
                 }
+                return *topology;
             }
-            return false;
-        }
 
-        bool contains_elem_with_val1_val2(int val1, int val2){ // Does the queue contain an element whose first two values are val1 and val2
-            for(int i=0; i<queue.size(); ++i){
-                if(queue[i].get_value1()==val1 \
-                && queue[i].get_value2()==val2){
-                    return true;
-                }
+            int get_border_length() const{
+                return border_length;
             }
-            return false;
-        }
 
-        bool contains_elem_with_val1(int val1){ // Does the queue contain an element whose first value is val1
-            for(int i=0; i<queue.size(); ++i){
-                if(queue[i].get_value1()==val1){
-                    return true;
+            int V() const{ // Number of cells
+                return border_length*border_length;
+            }
+
+            int coordinate_to_nodeIndex(int x, int y) const{
+                if(x<0 || x>border_length-1 || y<0 || y>border_length-1){
+                    cout<<"Coordinates aren't valid. Out of range";
+                    return -999;
                 }
+                return x*border_length+y;
             }
-            return false;
-        }
 
-        bool contains_elem_with_val2(int val2){ // Does the queue contain an element whose second value is val2
-            for(int i=0; i<queue.size(); ++i){
-                if(queue[i].get_value2()==val2){
-                    return true;
+            pair<int, int> nodeIndex_to_coordinate(int node) const{
+                return pair<int, int>(x_of[node], y_of[node]);
+            }
+
+            template<typename neighborCallback>
+            void for_each_neighbor(int node, neighborCallback callback) const{ // Calls callback(neighbor)
+                for(int k=neighbor_offsets[node]; k<neighbor_offsets[node+1]; ++k){
+                    callback(neighbor_nodes[k]);
                 }
+                return;
             }
-            return false;
-        }
 
-        bool theres_any_in_queue_not_in_ref(vector<int_int_and_num_Triad<numType>> ref_queue){
-            if(queue.size()>0 && ref_queue.size()==0){
-                return true;
+            const vector<int>& get_start_border(int player) const{ // North border for player 1 ("X"),
+            // West border for player 2 ("O")
+                return (player==1)?north_nodes:west_nodes;
             }
-            bool condition = true;
-            for(int i=0; i<queue.size(); ++i){
-                for(int j=0; j<ref_queue.size(); ++j){
-                    if(ref_queue[j].get_value1()==queue[i].get_value1()&&\
-                    ref_queue[j].get_value2()==queue[i].get_value2()&&\
-                    ref_queue[j].get_value3()==queue[i].get_value3()){
-                        condition = false;
-                        break;
-                    }
+
+            bool is_on_start_border(int player, int node) const{ // North border for player 1, West border for player 2
+                return (player==1)?(x_of[node]==0):(y_of[node]==0);
+            }
+
+            bool is_on_end_border(int player, int node) const{ // South border for player 1, East border for player 2
+                return (player==1)?(x_of[node]==border_length-1):(y_of[node]==border_length-1);
+            }
+
+            const Hex_Board& get_blank_board() const{ // An empty board graph, for the classes which work on
+            // Hex_Board. Its copies share its topology (see Graph::detach_topology)
+                return blank_board;
+            }
+
+        private:
+            BoardTopology(int border_length):border_length(border_length),blank_board(border_length){
+                int size = border_length*border_length;
+                for(int node=0; node<size; ++node){
+                    x_of.push_back(node/border_length);
+                    y_of.push_back(node%border_length);
                 }
-                if(condition==false){
-                    break;
+                // The same six neighbors as in the Hex_Board graph (see Board_Tables), as compact lists:
+                neighbor_offsets.assign(size+1, 0);
+                Board_Tables::for_each_neighbor_pair(border_length, [&](int node, int, int neighbor){
+                    neighbor_nodes.push_back(neighbor);
+                    neighbor_offsets[node+1] = neighbor_nodes.size();
+                });
+                for(int node=0; node<size; ++node){ // (For the cells with no neighbors, on a 1x1 board)
+                    neighbor_offsets[node+1] = max(neighbor_offsets[node+1], neighbor_offsets[node]);
+                }
+                for(int i=0; i<border_length; ++i){
+                    north_nodes.push_back(i);
+                    west_nodes.push_back(i*border_length);
                 }
             }
-            return condition;
-        }
 
-        int_int_and_num_Triad<numType> get_first_in_queue_not_in_ref_NotDelete(vector<int_int_and_num_Triad<numType>> ref_queue){
-            if(queue.size()>0 && ref_queue.size()==0){
-                return queue[0];
-            }
-            bool aux = false;
-            for(int i=0; i<queue.size(); ++i){
-                for(int j=0; j<ref_queue.size(); ++j){
-                    if(ref_queue[j].get_value1()==queue[i].get_value1()&&\
-                    ref_queue[j].get_value2()==queue[i].get_value2()&&\
-                    ref_queue[j].get_value3()==queue[i].get_value3()){
-                        aux = true;
-                        break;
+            int border_length;
+            vector<int> neighbor_offsets; // The neighbors of node are neighbor_nodes[neighbor_offsets[node]],
+            vector<int> neighbor_nodes; // ..., neighbor_nodes[neighbor_offsets[node+1]-1]
+            vector<int> x_of; // Coordinates of each node
+            vector<int> y_of;
+            vector<int> north_nodes;
+            vector<int> west_nodes;
+            Hex_Board blank_board;
+    };
+
+    // ===============================================================================================
+    // class Position
+    // ===============================================================================================
+    class Position{
+        // The state of a game: the stones on the board (0 empty, 1 player 1 "X", 2 player 2 "O"), the
+        // player to move and the number of moves made. The board itself is a shared BoardTopology, so a
+        // position is just N*N bytes and copying it is a single block copy.
+        // It has the same node tag methods as Hex_Board, so the classes templated on the board type
+        // (such as Pattern_Codes) work with both.
+
+        public:
+            explicit Position(int border_length=11, int side_to_move=1):topology(&BoardTopology::of(border_length)),\
+            stones(border_length*border_length, 0),side_to_move(side_to_move),move_count(0){}
+
+            Position(const Hex_Board& board, int side_to_move):topology(&BoardTopology::of(board.get_border_length())),\
+            side_to_move(side_to_move),move_count(0){ // The stones of board (its node tags)
+                for(int node=0; node<board.V(); ++node){
+                    stones.push_back(board.get_node_tag(node));
+                    if(stones[node]!=0){
+                        ++move_count;
                     }
                 }
-                if(aux==false){
-                    return queue[i];
-                }
             }
-            return int_int_and_num_Triad<numType>(-1, -1, static_cast<numType>(-1));
-        }
 
-        int_int_and_num_Triad<numType> getAndDelete_first_in_queue_not_in_ref(vector<int_int_and_num_Triad<numType>> ref_queue){
-            if(queue.size()>0 && ref_queue.size()==0){
-                int_int_and_num_Triad<numType> temp = queue[0];
-                queue.erase(queue.begin());
-                return temp;
+            void play(int node){ // Places a stone of the player to move and passes the turn
+                stones[node] = side_to_move;
+                side_to_move = (side_to_move%2)+1;
+                ++move_count;
+                return;
             }
-            bool aux = false;
-            for(int i=0; i<queue.size(); ++i){
-                for(int j=0; j<ref_queue.size(); ++j){
-                    if(ref_queue[j].get_value1()==queue[i].get_value1()&&\
-                    ref_queue[j].get_value2()==queue[i].get_value2()&&\
-                    ref_queue[j].get_value3()==queue[i].get_value3()){
-                        aux = true;
-                        break;
+
+            void swap(int node){ // Swap rule: the player to move takes over the stone of node, and passes the turn
+                play(node);
+                return;
+            }
+
+            void undo_play(int node, int previous_tag){ // Takes back play(node) or swap(node), given what node had
+                stones[node] = previous_tag;
+                side_to_move = (side_to_move%2)+1;
+                --move_count;
+                return;
+            }
+
+            bool has_connection(int player) const{ // True if the stones of player connect their two borders.
+            // A depth-first search from the stones on the start border, which stops at the end border
+                vector<int> pending;
+                vector<uint8_t> reached(stones.size(), 0);
+                for(int node : topology->get_start_border(player)){
+                    if(stones[node]==player){
+                        reached[node] = 1;
+                        pending.push_back(node);
                     }
                 }
-                if(aux==false){
-                    int_int_and_num_Triad<numType> temp = queue[i];
-                    queue.erase(queue.begin()+i);
-                    return temp;
+                while(pending.size()>0){
+                    int node = pending.back();
+                    pending.pop_back();
+                    if(topology->is_on_end_border(player, node)){
+                        return true;
+                    }
+                    topology->for_each_neighbor(node, [&](int neighbor){
+                        if(reached[neighbor]==0 && stones[neighbor]==player){
+                            reached[neighbor] = 1;
+                            pending.push_back(neighbor);
+                        }
+                    });
                 }
+                return false;
             }
-            return int_int_and_num_Triad<numType>(-1, -1, static_cast<numType>(-1));
-        }
 
-        void insert(int_int_and_num_Triad<numType> new_element){ // Insert new_element into the queue.
-        // It will be inserted respecting the increasing order of cost in the queue.
-            if(queue.size()==0){
-                queue.push_back(new_element);
+            Hex_Board to_board() const{ // An Hex_Board with these stones as node tags (for the classes which
+            // work on the board graph: the solver, the opening book, the evaluator...)
+                Hex_Board board(topology->get_blank_board());
+                for(int node=0; node<V(); ++node){
+                    board.set_node_tag(node, stones[node]);
+                }
+                return board;
+            }
+
+            void draw_board_ASCII(bool clear_screen_previously = true, const Heatmap* heatmap = nullptr) const{
+                to_board().draw_board_ASCII(clear_screen_previously, heatmap);
                 return;
             }
-            for(int i=0; i<queue.size(); ++i){
-                if(queue[i].get_value3()>=new_element.get_value3()){
-                    queue.insert(queue.begin()+i, new_element);
-                    return;
+
+            // Text form of a position: the cells in the order of draw_board_ASCII() (row x=0 from y=0 to
+            // y=N-1, then row x=1...), as '.', 'X' (player 1) and 'O' (player 2), e.g. "X...O.X.." for 3 x 3.
+            // A '/' may separate the rows. The board size is given by the number of cells.
+            string to_text() const{
+                string text;
+                for(int node=0; node<V(); ++node){
+                    if(node>0 && node%get_border_length()==0){
+                        text += '/';
+                    }
+                    text += (stones[node]==1)?'X':((stones[node]==2)?'O':'.');
                 }
+                return text;
             }
-            queue.push_back(new_element);
-            return;
-        }
 
-        int_int_and_num_Triad<numType> get_top_NotDelete(){ // Returns the top element of the queue
-            return queue[0];
-        }
+            static bool from_text(string text, Position& position, int side_to_move=0){ // False if text isn't a
+            // square board. Without side_to_move, it's the player with fewer stones (player 1 if they have the same)
+                vector<uint8_t> cells;
+                for(char c : text){
+                    if(c=='.'){
+                        cells.push_back(0);
+                    }else if(c=='X' || c=='x'){
+                        cells.push_back(1);
+                    }else if(c=='O' || c=='o'){
+                        cells.push_back(2);
+                    }else if(c!='/'){
+                        return false;
+                    }
+                }
+                int border_length = static_cast<int>(sqrt(static_cast<double>(cells.size()))+0.5);
+                if(border_length<1 || border_length*border_length!=static_cast<int>(cells.size())){
+                    return false;
+                }
+                int n_stones[3] = {0, 0, 0};
+                for(uint8_t cell : cells){
+                    ++n_stones[cell];
+                }
+                if(side_to_move!=1 && side_to_move!=2){
+                    side_to_move = (n_stones[2]<n_stones[1])?2:1;
+                }
+                position = Position(border_length, side_to_move);
+                position.stones = cells;
+                position.move_count = n_stones[1]+n_stones[2];
+                return true;
+            }
 
-        int_int_and_num_Triad<numType> get_top_and_delete(){ // Returns the top element of the queue
-        // and deletes it from the queue
-            int_int_and_num_Triad<numType> temp;
-            temp = queue[0];
-            queue.erase(queue.begin());
-            return temp;
-        }
+            Position transposed() const{ // The same position seen by the other player: the board transposed
+            // (cell (x,y) goes to (y,x)) and the colours swapped, so that player 1's moves become player 2's
+            // moves on the image and vice versa. (The engine only plays as player 2)
+                Position image(get_border_length(), (side_to_move%2)+1);
+                for(int node=0; node<V(); ++node){
+                    image.stones[transpose_node(node)] = (stones[node]==0)?0:3-stones[node];
+                }
+                image.move_count = move_count;
+                return image;
+            }
 
-        int_int_and_num_Triad<numType> get_element_n_NotDelete(int n){ // Returns the nth element of the queue
-            return queue[n];
-        }
+            int transpose_node(int node) const{ // The cell of node on the transposed board (and back)
+                return (node%get_border_length())*get_border_length()+(node/get_border_length());
+            }
 
-        int_int_and_num_Triad<numType> get_element_n_and_delete(int n){ // Returns the nth element of the queue
-        // and deletes it from the queue
-            int_int_and_num_Triad<numType> temp;
-            temp = queue[n];
-            queue.erase(queue.begin()+n);
-            return temp;
-        }
+            int get_node_tag(int node) const{
+                return stones[node];
+            }
 
-        void delete_top(){ // Removes the top element from the queue
-            queue.erase(queue.begin());
-            return;
-        }
+            void set_node_tag(int node, int tag){ // Changes a stone, without changing the turn nor the moves
+                stones[node] = tag;
+                return;
+            }
 
-        int size(){ // Returns the number of queue_elements
-            return queue.size();
-        }
+            int get_node_tag_byCoordinates(int x, int y) const{
+                return stones[topology->coordinate_to_nodeIndex(x,y)];
+            }
 
-        bool improves_cost_of_node(int_int_and_num_Triad<numType> new_element){ // Returns bool only if
-        // the new_element has LESS total cost, for its nodeTo (the second value of the triad), than
-        // all of the existing elements which contain that nodeTo.
-            for(int i=0; i<queue.size(); ++i){
-                if(queue[i].get_value2()==new_element.get_value2() \
-                && queue[i].get_value3()<=new_element.get_value3()){
-                    return false;
-                }
+            const BoardTopology& get_topology() const{
+                return *topology;
             }
-            return true;
-        }
 
-        void update_queue_with_shorter_path(int_int_and_num_Triad<numType> new_element){
-            for(int i=0; i<queue.size(); ++i){
-                for(int k=0; k<queue.size(); ++k){
-                    if(queue[k].get_value2()==new_element.get_value2()){
-                        queue.erase(queue.begin()+k);
-                        break;
-                    }
-                }
+            int V() const{
+                return stones.size();
+            }
+
+            int get_border_length() const{
+                return topology->get_border_length();
+            }
+
+            int get_side_to_move() const{
+                return side_to_move;
+            }
+
+            void set_side_to_move(int player){
+                side_to_move = player;
+                return;
+            }
+
+            int get_move_count() const{
+                return move_count;
             }
-            insert(new_element);
-            return;
-        }
 
         private:
-            vector<int_int_and_num_Triad<numType>> queue;
+            const BoardTopology* topology;
+            vector<uint8_t> stones;
+            int side_to_move;
+            int move_count;
     };
-    
+
     // ===============================================================================================
-    // class ShortestPath
+    // class Game_State
     // ===============================================================================================
-    template<typename graphType, typename numType>
-    class ShortestPath{
+    class Game_State{
+        // A Position plus what the game needs to know after every move, kept up to date incrementally
+        // instead of being recomputed from the whole board:
+        //      - The groups of stones of each player (union-find over the cells, with union by size), each
+        //        with flags telling which borders of its player it touches. A player has won when one of
+        //        their groups touches both borders.
+        //      - The list of empty cells (with the index of each cell in the list, for O(1) removal).
+        // Placing a stone on an empty cell costs O(log n) (no path compression, so that the unions can be
+        // rolled back). The swap rule rebuilds everything in O(n), as groups can't be split.
+        // The moves are kept in a stack, together with what each one changed (the unions it did, the place
+        // of its cell in the empty list...), so that undo() takes back the last move in O(1) and redo()
+        // plays it again. A swap is undone by restoring a copy of the state saved before it.
+        // (Position stays a plain block of stones, as the bot copies it for every random game)
 
         public:
-            // Constructor:
-            ShortestPath(graphType& graph):graph(graph),path_was_seeked(false),path_exists(false),\
-            nodeFrom(0),nodeTo(0),nodeTo_was_visited(false),terminated(false),\
-            shortest_path_cost(numeric_limits<numType>::infinity()>numeric_limits<numType>::max()?numeric_limits<numType>::infinity():numeric_limits<numType>::max()){}
-            // Notice that graph is passed as a & type, in order to use pass-by-breference and so
-            // we are not copying the object but using the original object. We could have marked it
-            // as constant (const graphType& graph) to avoid the original object being changed, but
-            // here we prefer to save the changes (for example, if we compute the Edge list from
-            // the Connectivity matrix we want to keep the newly computed Edge list on the original
-            // object too). When declaring the variable, under "public" below  we have to use "&"
-            // there too!
+            explicit Game_State(int border_length=11, int side_to_move=1):position(border_length, side_to_move){
+                rebuild();
+            }
 
-            // Destructor:
-            ~ShortestPath(){
-                open_set.clear();
-                closed_set.clear();
-                tentative_costs.clear();
-                neighbors.clear();
-                used_queue_elements.clear();
-                shortest_path.clear();
-                raw_shortest_path.clear();
+            explicit Game_State(const Position& position):position(position){
+                rebuild();
             }
 
-            bool i_is_in_vector(int i, vector<int> _vector){
-                bool result = false;
-                for(int k : _vector){
-                    if(k==i){
-                        result = true;
-                        break;
+            struct Move{
+                int node;
+                int player;
+                bool is_swap;
+            };
+
+            void play(int node){ // Places a stone of the player to move and passes the turn
+                make(Move{node, position.get_side_to_move(), false});
+                redo_stack.clear();
+                return;
+            }
+
+            void swap(int node){ // Swap rule: the player to move takes over the stone of node (see Position::swap)
+                make(Move{node, position.get_side_to_move(), true});
+                redo_stack.clear();
+                return;
+            }
+
+            bool undo(){ // Takes back the last move. False if there are no moves
+                if(moves.size()==0){
+                    return false;
+                }
+                Move last = moves.back();
+                Undo_Record& record = undo_records.back();
+                position.undo_play(last.node, record.previous_tag);
+                if(record.saved_state!=nullptr){
+                    parent = std::move(record.saved_state->parent);
+                    group_size = std::move(record.saved_state->group_size);
+                    border_flags = std::move(record.saved_state->border_flags);
+                    empty_cells = std::move(record.saved_state->empty_cells);
+                    index_in_empty = std::move(record.saved_state->index_in_empty);
+                }else{
+                    while(union_log.size()>record.union_log_size){ // Split the groups merged by the move
+                        Union_Record& merge = union_log.back();
+                        parent[merge.child] = merge.child;
+                        group_size[merge.root] -= group_size[merge.child];
+                        border_flags[merge.root] = merge.root_flags;
+                        union_log.pop_back();
                     }
+                    parent[last.node] = -1;
+                    group_size[last.node] = 0;
+                    border_flags[last.node] = 0;
+                    // Put the cell back in its place of the empty list (see place):
+                    int index = record.empty_index;
+                    if(index==static_cast<int>(empty_cells.size())){
+                        empty_cells.push_back(last.node);
+                    }else{
+                        int moved = empty_cells[index];
+                        index_in_empty[moved] = empty_cells.size();
+                        empty_cells.push_back(moved);
+                        empty_cells[index] = last.node;
+                    }
+                    index_in_empty[last.node] = index;
                 }
-                return result;
+                union_log.resize(record.union_log_size);
+                for(int player=0; player<3; ++player){
+                    connected[player] = record.previously_connected[player];
+                }
+                moves.pop_back();
+                undo_records.pop_back();
+                redo_stack.push_back(last);
+                return true;
             }
-            
-            void seek_path(int _nodeFrom, int _nodeTo, vector<int> avoid_nodes_with_these_tags=vector<int>()){
-                // This is the implementation of Dijkstra's algorithm
 
-                // Those nodes whose tag is contained in avoid_nodes_with_these_tags will not be considered
-                // for the possible paths
-
-                // First, clear variables in case a prior computation has been done on this object:
+            bool redo(){ // Plays again the last move taken back. False if there's none
+                if(redo_stack.size()==0){
+                    return false;
+                }
+                Move next = redo_stack.back();
+                redo_stack.pop_back();
+                make(next);
+                return true;
+            }
+
+            void set_node_tag(int node, int tag){ // Changes a stone, without changing the turn nor the moves. As
+            // it isn't a move, the moves made so far can't be taken back after it
+                position.set_node_tag(node, tag);
+                moves.clear();
+                undo_records.clear();
+                redo_stack.clear();
+                union_log.clear();
+                rebuild();
+                return;
+            }
+
+            const vector<Move>& get_moves() const{ // The moves made (and not taken back), the last one at the end
+                return moves;
+            }
+
+            int get_n_redo_moves() const{
+                return redo_stack.size();
+            }
+
+            void set_side_to_move(int player){
+                position.set_side_to_move(player);
+                return;
+            }
+
+            bool has_connection(int player) const{ // O(1)
+                return connected[player];
+            }
+
+            int get_winner() const{ // 0 if nobody has connected their borders yet
+                return connected[1]?1:(connected[2]?2:0);
+            }
+
+            const vector<int>& get_empty_cells() const{ // In no particular order
+                return empty_cells;
+            }
+
+            int get_move_count() const{
+                return position.get_move_count();
+            }
+
+            const Position& get_position() const{
+                return position;
+            }
+
+        private:
+            struct Union_Record{ // A merge of two groups: child was attached to root, whose flags were root_flags
+                int root;
+                int child;
+                uint8_t root_flags;
+            };
+
+            struct Saved_State{ // The state before a swap
+                vector<int> parent;
+                vector<int> group_size;
+                vector<uint8_t> border_flags;
+                vector<int> empty_cells;
+                vector<int> index_in_empty;
+            };
+
+            struct Undo_Record{ // What a move changed
+                int previous_tag; // Of the cell of the move
+                int empty_index; // Index of the cell in the empty list, before the move
+                size_t union_log_size; // Size of union_log before the move
+                bool previously_connected[3];
+                unique_ptr<Saved_State> saved_state; // Only for the swaps
+            };
+
+            void make(const Move& next){
+                Undo_Record record;
+                record.previous_tag = position.get_node_tag(next.node);
+                record.empty_index = index_in_empty[next.node];
+                record.union_log_size = union_log.size();
+                for(int player=0; player<3; ++player){
+                    record.previously_connected[player] = connected[player];
+                }
+                position.set_side_to_move(next.player);
+                if(!next.is_swap && record.previous_tag==0){
+                    position.play(next.node);
+                    place(next.node, next.player);
+                }else{
+                    record.saved_state.reset(new Saved_State{parent, group_size, border_flags, empty_cells, index_in_empty});
+                    position.swap(next.node);
+                    rebuild();
+                }
+                moves.push_back(next);
+                undo_records.push_back(std::move(record));
+                return;
+            }
+
+            void rebuild(){ // Recomputes everything from the stones of the position
+                int size = position.V();
+                parent.assign(size, -1);
+                group_size.assign(size, 0);
+                border_flags.assign(size, 0);
+                empty_cells.clear();
+                index_in_empty.assign(size, -1);
+                connected[0] = connected[1] = connected[2] = false;
+                size_t log_size = union_log.size(); // (A rebuild isn't undone by splitting groups)
+                for(int node=0; node<size; ++node){
+                    if(position.get_node_tag(node)==0){
+                        index_in_empty[node] = empty_cells.size();
+                        empty_cells.push_back(node);
+                    }
+                }
+                for(int node=0; node<size; ++node){
+                    if(position.get_node_tag(node)!=0){
+                        join_stone(node, position.get_node_tag(node));
+                    }
+                }
+                union_log.resize(log_size);
+                return;
+            }
+
+            void place(int node, int player){ // A stone of player on the empty cell node
+                int last = empty_cells.back();
+                empty_cells[index_in_empty[node]] = last;
+                index_in_empty[last] = index_in_empty[node];
+                empty_cells.pop_back();
+                index_in_empty[node] = -1;
+                join_stone(node, player);
+                return;
+            }
+
+            void join_stone(int node, int player){ // Makes node a group, and merges it with the neighbor groups
+            // of the same player
+                const BoardTopology& topology = position.get_topology();
+                parent[node] = node;
+                group_size[node] = 1;
+                border_flags[node] = (topology.is_on_start_border(player, node)?1:0)|\
+                (topology.is_on_end_border(player, node)?2:0);
+                topology.for_each_neighbor(node, [&](int neighbor){
+                    if(position.get_node_tag(neighbor)==player && parent[neighbor]>=0){
+                        unite(node, neighbor);
+                    }
+                });
+                if(border_flags[find(node)]==3){
+                    connected[player] = true;
+                }
+                return;
+            }
+
+            int find(int node) const{ // (No path compression, see above. Union by size keeps the depth O(log n))
+                while(parent[node]!=node){
+                    node = parent[node];
+                }
+                return node;
+            }
+
+            void unite(int a, int b){
+                a = find(a);
+                b = find(b);
+                if(a==b){
+                    return;
+                }
+                if(group_size[a]<group_size[b]){
+                    std::swap(a, b);
+                }
+                union_log.push_back(Union_Record{a, b, border_flags[a]});
+                parent[b] = a;
+                group_size[a] += group_size[b];
+                border_flags[a] |= border_flags[b];
+                return;
+            }
+
+            Position position;
+            vector<int> parent; // Union-find of the stones (-1 for the empty cells)
+            vector<int> group_size;
+            vector<uint8_t> border_flags; // Of each group root: 1 start border, 2 end border of its player
+            vector<int> empty_cells;
+            vector<int> index_in_empty; // -1 for the occupied cells
+            bool connected[3]; // connected[player]
+            vector<Move> moves;
+            vector<Undo_Record> undo_records; // undo_records[k] is what moves[k] changed
+            vector<Move> redo_stack;
+            vector<Union_Record> union_log; // The merges done by the moves in the stack, in order
+    };
+
+    // ===============================================================================================
+    // class Engine
+    // ===============================================================================================
+    struct Playout{ // Result of a random game stopped as soon as it's decided (see Engine::random_game)
+        int winner;
+        int n_moves; // Stones placed in the random game until a player connected (including the fixed move)
+    };
+
+    template<int N>
+    class Engine{
+        // Random games and win checks for the boards of border length N, with the size known at compile
+        // time. The stones of a player are a bitboard (bit x*N+y of an array of WORDS words), and the six
+        // neighbors of every cell are reached at once by shifting the whole bitboard:
+        //      (x-1,y): -N     (x-1,y+1): -(N-1)     (x,y-1): -1
+        //      (x+1,y): +N     (x+1,y-1): +(N-1)     (x,y+1): +1
+        // The shifts that move along a row are masked so that they don't wrap around to the next row.
+        // All of the masks are constexpr (see Board_Tables), and every loop has a constant bound, so the
+        // compiler unrolls them. Use it through Engine_Dispatcher, which picks the instance of the board's size.
+
+        public:
+            static constexpr int SIZE = N*N;
+            static constexpr int WORDS = Board_Tables::Of<N>::WORDS;
+            typedef typename Board_Tables::Of<N>::Bitboard Bitboard;
+
+            static bool has_connection(const Position& position, int player){ // Same as Position::has_connection
+                return connects(stones_of(position, player), player);
+            }
+
+            static bool bot_wins_random_game(const Position& position, int fixed_node, const vector<int>& order){
+                // Player 2 (the bot) plays fixed_node, and then the empty nodes of "order" are filled in
+                // that order, starting with player 1 and alternating. True if player 2 connects West and
+                // East (on a full board, otherwise player 1 has connected). Only the stones of player 2
+                // are needed, so no board is copied
+                Bitboard bot = stones_of(position, 2);
+                set_bit(bot, fixed_node);
+                int player = 1;
+                for(int node : order){
+                    if(node!=fixed_node && position.get_node_tag(node)==0){
+                        if(player==2){
+                            set_bit(bot, node);
+                        }
+                        player = (player%2)+1;
+                    }
+                }
+                return connects(bot, 2);
+            }
+
+            static Playout random_game(const Position& position, int fixed_node, const vector<int>& order){
+                // The same random game as bot_wins_random_game(), but stopped as soon as a player connects
+                // their borders. The groups of stones are kept in a union-find (union by size, path halving)
+                // while the stones are placed, and the root of each group has the flags of the borders of its
+                // player that the group touches (1: North or West, 2: South or East), which act as the border
+                // sentinels: a player has connected when the group of the last stone has both flags
+                Groups groups;
+                for(int node=0; node<SIZE; ++node){
+                    if(position.get_node_tag(node)!=0){
+                        groups.place(node, position.get_node_tag(node));
+                    }
+                }
+                Playout playout{2, 1};
+                if(groups.place(fixed_node, 2)){
+                    return playout;
+                }
+                int player = 1;
+                for(int node : order){
+                    if(groups.cells[node]==0){
+                        ++playout.n_moves;
+                        if(groups.place(node, player)){
+                            playout.winner = player;
+                            return playout;
+                        }
+                        player = (player%2)+1;
+                    }
+                }
+                playout.winner = 0; // (Only if order doesn't have every empty node)
+                return playout;
+            }
+
+        private:
+            struct Groups{ // Union-find of the stones of random_game()
+                array<uint8_t, SIZE> cells{}; // Stones (0 = empty)
+                array<int16_t, SIZE> parent;
+                array<int16_t, SIZE> group_size;
+                array<uint8_t, SIZE> border_flags; // (Only meaningful at the roots)
+
+                bool place(int node, int player){ // Adds a stone. True if its group connects the borders of player
+                    cells[node] = player;
+                    int line = (player==1)?node/N:node%N; // (Row for player 1, column for player 2)
+                    int root = node;
+                    parent[node] = node;
+                    group_size[node] = 1;
+                    border_flags[node] = ((line==0)?1:0)|((line==N-1)?2:0);
+                    for(int d=0; d<Board_Tables::N_DIRECTIONS; ++d){
+                        int neighbor = Board_Tables::Of<N>::NEIGHBORS[node*Board_Tables::N_DIRECTIONS+d];
+                        if(neighbor<0 || cells[neighbor]!=player){
+                            continue;
+                        }
+                        int other = find(neighbor);
+                        if(other==root){
+                            continue;
+                        }
+                        if(group_size[other]>group_size[root]){
+                            std::swap(other, root);
+                        }
+                        parent[other] = root;
+                        group_size[root] += group_size[other];
+                        border_flags[root] |= border_flags[other];
+                    }
+                    return border_flags[root]==3;
+                }
+
+                int find(int node){
+                    while(parent[node]!=node){
+                        parent[node] = parent[parent[node]];
+                        node = parent[node];
+                    }
+                    return node;
+                }
+            };
+
+            static Bitboard stones_of(const Position& position, int player){
+                Bitboard stones{};
+                for(int node=0; node<SIZE; ++node){
+                    if(position.get_node_tag(node)==player){
+                        set_bit(stones, node);
+                    }
+                }
+                return stones;
+            }
+
+            static bool connects(const Bitboard& stones, int player){ // Flood fill from the start border of
+            // player through its stones, until it stops growing or it reaches the end border
+                const Bitboard& start = (player==1)?Board_Tables::Of<N>::NORTH:Board_Tables::Of<N>::WEST;
+                const Bitboard& end = (player==1)?Board_Tables::Of<N>::SOUTH:Board_Tables::Of<N>::EAST;
+                Bitboard reached;
+                for(int w=0; w<WORDS; ++w){
+                    reached[w] = stones[w]&start[w];
+                }
+                while(true){
+                    Bitboard grown = expand(reached);
+                    bool changed = false;
+                    bool at_end = false;
+                    for(int w=0; w<WORDS; ++w){
+                        grown[w] &= stones[w];
+                        changed |= (grown[w]!=reached[w]);
+                        at_end |= ((grown[w]&end[w])!=0);
+                    }
+                    if(at_end){
+                        return true;
+                    }
+                    if(!changed){
+                        return false;
+                    }
+                    reached = grown;
+                }
+            }
+
+            static Bitboard expand(const Bitboard& b){ // b and its six neighbors (may include bits outside the board)
+                Bitboard not_first_column;
+                Bitboard not_last_column;
+                for(int w=0; w<WORDS; ++w){
+                    not_first_column[w] = b[w]&~Board_Tables::Of<N>::WEST[w];
+                    not_last_column[w] = b[w]&~Board_Tables::Of<N>::EAST[w];
+                }
+                Bitboard up_n = shift_up(b, N);
+                Bitboard down_n = shift_down(b, N);
+                Bitboard up_1 = shift_up(not_last_column, 1);
+                Bitboard down_1 = shift_down(not_first_column, 1);
+                Bitboard up_n_1 = shift_up(not_first_column, N-1);
+                Bitboard down_n_1 = shift_down(not_last_column, N-1);
+                Bitboard result;
+                for(int w=0; w<WORDS; ++w){
+                    result[w] = b[w]|up_n[w]|down_n[w]|up_1[w]|down_1[w]|up_n_1[w]|down_n_1[w];
+                }
+                return result;
+            }
+
+            static Bitboard shift_up(const Bitboard& b, int k){ // Towards the higher bits (0<k<64)
+                Bitboard result;
+                for(int w=WORDS-1; w>=0; --w){
+                    result[w] = (b[w]<<k)|((w>0)?(b[w-1]>>(64-k)):0);
+                }
+                return result;
+            }
+
+            static Bitboard shift_down(const Bitboard& b, int k){ // Towards the lower bits (0<k<64)
+                Bitboard result;
+                for(int w=0; w<WORDS; ++w){
+                    result[w] = (b[w]>>k)|((w<WORDS-1)?(b[w+1]<<(64-k)):0);
+                }
+                return result;
+            }
+
+            static void set_bit(Bitboard& b, int node){
+                b[node>>6] |= static_cast<uint64_t>(1)<<(node&63);
+                return;
+            }
+    };
+
+    // ===============================================================================================
+    // class Engine_Dispatcher
+    // ===============================================================================================
+    class Engine_Dispatcher{
+        // Runtime dispatch to Engine<N> for the board sizes it's compiled for (MIN_ENGINE_BORDER_LENGTH
+        // to MAX_ENGINE_BORDER_LENGTH). The other sizes fall back to the generic Position methods.
+
+        public:
+            static bool has_connection(const Position& position, int player){
+                const Engine_Functions* functions = functions_for(position.get_border_length());
+                if(functions==nullptr){
+                    return position.has_connection(player);
+                }
+                return functions->has_connection(position, player);
+            }
+
+            static bool bot_wins_random_game(const Position& position, int fixed_node, const vector<int>& order){
+                // (See Engine::bot_wins_random_game)
+                const Engine_Functions* functions = functions_for(position.get_border_length());
+                if(functions!=nullptr){
+                    return functions->bot_wins_random_game(position, fixed_node, order);
+                }
+                Position aux_position(position);
+                aux_position.set_node_tag(fixed_node, 2);
+                int player = 1;
+                for(int node : order){
+                    if(node!=fixed_node && position.get_node_tag(node)==0){
+                        aux_position.set_node_tag(node, player);
+                        player = (player%2)+1;
+                    }
+                }
+                return aux_position.has_connection(2);
+            }
+
+            static Playout random_game(const Position& position, int fixed_node, const vector<int>& order){
+                // (See Engine::random_game. The other sizes fill the whole board, so n_moves is the number of
+                // empty nodes)
+                const Engine_Functions* functions = functions_for(position.get_border_length());
+                if(functions!=nullptr){
+                    return functions->random_game(position, fixed_node, order);
+                }
+                int n_moves = 0;
+                for(int node=0; node<position.V(); ++node){
+                    n_moves += (position.get_node_tag(node)==0)?1:0;
+                }
+                return Playout{bot_wins_random_game(position, fixed_node, order)?2:1, n_moves};
+            }
+
+        private:
+            struct Engine_Functions{
+                bool (*has_connection)(const Position&, int);
+                bool (*bot_wins_random_game)(const Position&, int, const vector<int>&);
+                Playout (*random_game)(const Position&, int, const vector<int>&);
+            };
+
+            static const Engine_Functions* functions_for(int border_length){
+                static const array<Engine_Functions, MAX_ENGINE_BORDER_LENGTH+1> table =\
+                make_table(make_integer_sequence<int, MAX_ENGINE_BORDER_LENGTH-MIN_ENGINE_BORDER_LENGTH+1>());
+                if(border_length<MIN_ENGINE_BORDER_LENGTH || border_length>MAX_ENGINE_BORDER_LENGTH){
+                    return nullptr;
+                }
+                return &table[border_length];
+            }
+
+            template<int... K>
+            static array<Engine_Functions, MAX_ENGINE_BORDER_LENGTH+1> make_table(integer_sequence<int, K...>){
+                array<Engine_Functions, MAX_ENGINE_BORDER_LENGTH+1> table{};
+                ((table[MIN_ENGINE_BORDER_LENGTH+K] = Engine_Functions{&Engine<MIN_ENGINE_BORDER_LENGTH+K>::has_connection,\
+                &Engine<MIN_ENGINE_BORDER_LENGTH+K>::bot_wins_random_game, &Engine<MIN_ENGINE_BORDER_LENGTH+K>::random_game}), ...);
+                return table;
+            }
+    };
+
+    // ===============================================================================================
+    // class PriorityQueue
+    // ===============================================================================================
+    template<typename numType>
+    class PriorityQueue{
+        public:
+            PriorityQueue(){} // Default constructor
+
+            ~PriorityQueue(){queue.clear();} // Destructor
+        
+        void change_Prioirity(int index, int new_position){ // Changes the priority of queue element
+            int_int_and_num_Triad<numType> temp;
+            temp = queue[index];
+            queue.erase(queue.begin()+index);
+            queue.insert(queue.begin()+new_position, temp);
+            return;
+        }
+
+        bool contains(int_int_and_num_Triad<numType> queue_element){ // Does the queue contain queue_element
+            for(int i=0; i<queue.size(); ++i){
+                if(queue[i].get_value1()==queue_element.get_value1() \
+                && queue[i].get_value2()==queue_element.get_value2() \
+                && queue[i].get_value3()==queue_element.get_value3()){
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool contains_elem_with_val1_val2(int val1, int val2){ // Does the queue contain an element whose first two values are val1 and val2
+            for(int i=0; i<queue.size(); ++i){
+                if(queue[i].get_value1()==val1 \
+                && queue[i].get_value2()==val2){
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool contains_elem_with_val1(int val1){ // Does the queue contain an element whose first value is val1
+            for(int i=0; i<queue.size(); ++i){
+                if(queue[i].get_value1()==val1){
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool contains_elem_with_val2(int val2){ // Does the queue contain an element whose second value is val2
+            for(int i=0; i<queue.size(); ++i){
+                if(queue[i].get_value2()==val2){
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool theres_any_in_queue_not_in_ref(vector<int_int_and_num_Triad<numType>> ref_queue){
+            if(queue.size()>0 && ref_queue.size()==0){
+                return true;
+            }
+            bool condition = true;
+            for(int i=0; i<queue.size(); ++i){
+                for(int j=0; j<ref_queue.size(); ++j){
+                    if(ref_queue[j].get_value1()==queue[i].get_value1()&&\
+                    ref_queue[j].get_value2()==queue[i].get_value2()&&\
+                    ref_queue[j].get_value3()==queue[i].get_value3()){
+                        condition = false;
+                        break;
+                    }
+                }
+                if(condition==false){
+                    break;
+                }
+            }
+            return condition;
+        }
+
+        int_int_and_num_Triad<numType> get_first_in_queue_not_in_ref_NotDelete(vector<int_int_and_num_Triad<numType>> ref_queue){
+            if(queue.size()>0 && ref_queue.size()==0){
+                return queue[0];
+            }
+            bool aux = false;
+            for(int i=0; i<queue.size(); ++i){
+                for(int j=0; j<ref_queue.size(); ++j){
+                    if(ref_queue[j].get_value1()==queue[i].get_value1()&&\
+                    ref_queue[j].get_value2()==queue[i].get_value2()&&\
+                    ref_queue[j].get_value3()==queue[i].get_value3()){
+                        aux = true;
+                        break;
+                    }
+                }
+                if(aux==false){
+                    return queue[i];
+                }
+            }
+            return int_int_and_num_Triad<numType>(-1, -1, static_cast<numType>(-1));
+        }
+
+        int_int_and_num_Triad<numType> getAndDelete_first_in_queue_not_in_ref(vector<int_int_and_num_Triad<numType>> ref_queue){
+            if(queue.size()>0 && ref_queue.size()==0){
+                int_int_and_num_Triad<numType> temp = queue[0];
+                queue.erase(queue.begin());
+                return temp;
+            }
+            bool aux = false;
+            for(int i=0; i<queue.size(); ++i){
+                for(int j=0; j<ref_queue.size(); ++j){
+                    if(ref_queue[j].get_value1()==queue[i].get_value1()&&\
+                    ref_queue[j].get_value2()==queue[i].get_value2()&&\
+                    ref_queue[j].get_value3()==queue[i].get_value3()){
+                        aux = true;
+                        break;
+                    }
+                }
+                if(aux==false){
+                    int_int_and_num_Triad<numType> temp = queue[i];
+                    queue.erase(queue.begin()+i);
+                    return temp;
+                }
+            }
+            return int_int_and_num_Triad<numType>(-1, -1, static_cast<numType>(-1));
+        }
+
+        void insert(int_int_and_num_Triad<numType> new_element){ // Insert new_element into the queue.
+        // It will be inserted respecting the increasing order of cost in the queue.
+            if(queue.size()==0){
+                queue.push_back(new_element);
+                return;
+            }
+            for(int i=0; i<queue.size(); ++i){
+                if(queue[i].get_value3()>=new_element.get_value3()){
+                    queue.insert(queue.begin()+i, new_element);
+                    return;
+                }
+            }
+            queue.push_back(new_element);
+            return;
+        }
+
+        int_int_and_num_Triad<numType> get_top_NotDelete(){ // Returns the top element of the queue
+            return queue[0];
+        }
+
+        int_int_and_num_Triad<numType> get_top_and_delete(){ // Returns the top element of the queue
+        // and deletes it from the queue
+            int_int_and_num_Triad<numType> temp;
+            temp = queue[0];
+            queue.erase(queue.begin());
+            return temp;
+        }
+
+        int_int_and_num_Triad<numType> get_element_n_NotDelete(int n){ // Returns the nth element of the queue
+            return queue[n];
+        }
+
+        int_int_and_num_Triad<numType> get_element_n_and_delete(int n){ // Returns the nth element of the queue
+        // and deletes it from the queue
+            int_int_and_num_Triad<numType> temp;
+            temp = queue[n];
+            queue.erase(queue.begin()+n);
+            return temp;
+        }
+
+        void delete_top(){ // Removes the top element from the queue
+            queue.erase(queue.begin());
+            return;
+        }
+
+        int size(){ // Returns the number of queue_elements
+            return queue.size();
+        }
+
+        bool improves_cost_of_node(int_int_and_num_Triad<numType> new_element){ // Returns bool only if
+        // the new_element has LESS total cost, for its nodeTo (the second value of the triad), than
+        // all of the existing elements which contain that nodeTo.
+            for(int i=0; i<queue.size(); ++i){
+                if(queue[i].get_value2()==new_element.get_value2() \
+                && queue[i].get_value3()<=new_element.get_value3()){
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void update_queue_with_shorter_path(int_int_and_num_Triad<numType> new_element){
+            for(int i=0; i<queue.size(); ++i){
+                for(int k=0; k<queue.size(); ++k){
+                    if(queue[k].get_value2()==new_element.get_value2()){
+                        queue.erase(queue.begin()+k);
+                        break;
+                    }
+                }
+            }
+            insert(new_element);
+            return;
+        }
+
+        private:
+            vector<int_int_and_num_Triad<numType>> queue;
+    };
+    
+    // ===============================================================================================
+    // class ShortestPath
+    // ===============================================================================================
+    template<typename graphType, typename numType>
+    class ShortestPath{
+
+        public:
+            // Constructor:
+            ShortestPath(graphType& graph):graph(graph),path_was_seeked(false),path_exists(false),\
+            nodeFrom(0),nodeTo(0),nodeTo_was_visited(false),terminated(false),\
+            shortest_path_cost(numeric_limits<numType>::infinity()>numeric_limits<numType>::max()?numeric_limits<numType>::infinity():numeric_limits<numType>::max()),\
+            expanded_nodes(0),tree_source(-1){}
+            // Notice that graph is passed as a & type, in order to use pass-by-breference and so
+            // we are not copying the object but using the original object. We could have marked it
+            // as constant (const graphType& graph) to avoid the original object being changed, but
+            // here we prefer to save the changes (for example, if we compute the Edge list from
+            // the Connectivity matrix we want to keep the newly computed Edge list on the original
+            // object too). When declaring the variable, under "public" below  we have to use "&"
+            // there too!
+
+            // Destructor:
+            ~ShortestPath(){
+                open_set.clear();
+                closed_set.clear();
+                tentative_costs.clear();
+                used_queue_elements.clear();
+                shortest_path.clear();
+                raw_shortest_path.clear();
+            }
+
+            bool i_is_in_vector(int i, vector<int> _vector){
+                bool result = false;
+                for(int k : _vector){
+                    if(k==i){
+                        result = true;
+                        break;
+                    }
+                }
+                return result;
+            }
+            
+            void seek_path(int _nodeFrom, int _nodeTo, vector<int> avoid_nodes_with_these_tags=vector<int>()){
+                // This is the implementation of Dijkstra's algorithm
+
+                // Those nodes whose tag is contained in avoid_nodes_with_these_tags will not be considered
+                // for the possible paths
+
+                // First, clear variables in case a prior computation has been done on this object:
+                if(path_was_seeked==true){
+                    open_set.clear();
+                    closed_set.clear();
+                    tentative_costs.clear();
+                    used_queue_elements.clear();
+                    shortest_path.clear();
+                    raw_shortest_path.clear();
+                    path_was_seeked = false;
+                    terminated = false;
+                    path_exists = false;
+                    nodeTo_was_visited = false;
+                    queue = PriorityQueue<numType>();
+                    last_top_of_queue = int_int_and_num_Triad<numType>();
+                    shortest_path_cost = 0;
+                }
+
+                // Set these two variables:
+                nodeFrom = _nodeFrom;
+                nodeTo = _nodeTo;
+
+                // Now mark those nodes which are banned
+                vector<int> banned_nodes;
+                for(int i=0; i<graph.V(); ++i){
+                    int tag_read = graph.get_node_tag(i);
+                    for(int banned_tag : avoid_nodes_with_these_tags){
+                        if(tag_read==banned_tag){
+                            banned_nodes.push_back(i);
+                            break;
+                        }
+                    }
+                }
+                // If nodeFrom or nodeTo are in banned_nodes, no path can be computed. Return:
+                for(int node : banned_nodes){
+                    if(node==nodeFrom || node==nodeTo){
+                        // cout<<"\nNo path can be computed because the source node or the destination node are prohibited nodes!"<<endl;
+                        terminated = true;
+                        path_was_seeked = true;
+                        path_exists = false;
+                        return;
+                    }
+                }
+                
+                // Begin computation:
+
+                // Label all of the not banned nodes, except for nodeFrom, as unvisited:
+                for(int i=0; i<graph.V(); ++i){
+                    if(!i_is_in_vector(i,banned_nodes)){
+                        if(i!=nodeFrom){
+                            open_set.push_back(i);
+                        }else{
+                            closed_set.push_back(i);
+                        }
+                    }
+                }
+
+                // Set tentative costs to infinity, except for the nodeFrom's which is zero:
+                for(int i=0; i<graph.V(); ++i){
+                    if(i!=nodeFrom){
+                        tentative_costs.push_back(numeric_limits<numType>::infinity()>numeric_limits<numType>::max()?numeric_limits<numType>::infinity():numeric_limits<numType>::max());
+                    }else{
+                        tentative_costs.push_back(0);
+                    }
+                }
+
+                // Begin iterating.
+                terminated = false;
+                currentNode = nodeFrom;
+                while(terminated == false){
+                    // Add to the priority queue (this is done in increasing order) those neighbours
+                    // of currentNode which are in the open set (they are read in place, without copies):
+                    for(int_and_num_Pair<numType> neighbor : graph.neighbor_view(currentNode)){
+                        if(find(open_set.begin(), open_set.end(), neighbor.get_value1()) != open_set.end() &&\
+                        !i_is_in_vector(neighbor.get_value1(),banned_nodes)){ // This means
+                            // if(neighbor.node_number is in open_set and neighbor.node_number is not banned)
+                            // But before adding those neighbors to the queue, their costs must be updated
+                            // to the current total value, by adding the cost of the currentNode up to now !
+                            int_and_num_Pair<numType> temp = neighbor;
+                            temp.set_value2(temp.get_value2() + tentative_costs[currentNode]);
+                            int_int_and_num_Triad<numType> triad = join_current_and_neighbor_and_cost(currentNode, temp);
+                            // Important: We must add the element to the queue if it improves the total cost towards
+                            // a new node. If that node is already with less or equal cost in the queue, don't add it.
+                            // But if it was in the queue with more cost, add the new one and delete the old one (update the queue)
+                            if(queue.contains_elem_with_val1_val2(triad.get_value1(), triad.get_value2())==false\
+                            && queue.improves_cost_of_node(triad)){
+                                queue.update_queue_with_shorter_path(triad);
+                            }
+                        }
+                    }
+                    // What happens if the currentNode doesn't have neigbors, nor has neighbors which are in the
+                    // open set, nor has neighbours which are in the open set and improve the cost?
+                    // --> Just nothing is added to the queue in this iteration
+
+                    // Now we choose the "To" node in the priority queue which has the least cost. That is
+                    // the top of the queue. We mark that node as current node for the next iteration.
+                    // we remove that element from the queue and we move that node from the open set to the
+                    // closed set. We also update the cost of that node up to now, by updating the value stored
+                    // in tentative_costs whit that one which the top of the queue contained.
+                    // Additionally, evaluate the terminating condition in order to know if the shortest path has been reached!
+                    if(queue.size()>0 && queue.theres_any_in_queue_not_in_ref(used_queue_elements)){
+                        int_int_and_num_Triad<numType> aux_top_of_queue = queue.get_first_in_queue_not_in_ref_NotDelete(used_queue_elements);
+                        if(aux_top_of_queue.get_value2()!=nodeTo){
+                            // We must not move the nodeTo
+                            // to the closed_set even if we are to reach it in this iteration, because
+                            // even having visited it, there may be other shorter paths that have to
+                            // be tested and exhausted.
+                            // Furthermore, if the upcoming node is nodeTo, the special code of the
+                            // else{} must be used, not this block.
+                            int_int_and_num_Triad<numType> another_aux_element = queue.getAndDelete_first_in_queue_not_in_ref(used_queue_elements);
+                            used_queue_elements.push_back(another_aux_element);
+                            last_top_of_queue = another_aux_element;
+                            currentNode = last_top_of_queue.get_value2();
+                            for(int i=0; i<open_set.size(); ++i){
+                                if(open_set[i]==currentNode){ 
+                                    open_set.erase(open_set.begin()+i);
+                                    closed_set.push_back(currentNode);
+                                    break;
+                                }
+                            }
+                            tentative_costs[currentNode] = last_top_of_queue.get_value3();
+                        }else{
+                            nodeTo_was_visited = true;
+                            int_int_and_num_Triad<numType> another_aux_element\
+                            = queue.get_first_in_queue_not_in_ref_NotDelete(used_queue_elements); // DON'T use delete, to be able to know afterwards
+                            // that this element of the queue has been used
+                            used_queue_elements.push_back(another_aux_element);
+                            last_top_of_queue = another_aux_element; // DON'T use delete, to be able to know afterwards
+                            // that this element of the queue has been used
+                            tentative_costs[currentNode] = last_top_of_queue.get_value3(); // Updates
+                            // the tentative cost of the nodeTo
+                            // Now, we have to focus on the next element of the queue (if it exists. If not,
+                            // we have terminated) to see which node has to be the currentNode. Set that
+                            // current node and proceed to the next iteration.
+                            if(queue.size()>0 && queue.theres_any_in_queue_not_in_ref(used_queue_elements)){
+                                currentNode = queue.get_first_in_queue_not_in_ref_NotDelete(used_queue_elements).get_value1();
+                                // Now, for the next iteration we have to avoid to enter on a loop, so we mustn't
+                                // add to the priority queue the neighbours that we have already added, and we
+                                // mustn't revisit the paths we have already run.
+                            }else{
+                                terminated = true;
+                                path_exists = true;
+                            }
+                        }
+                    }else{ // We have exhausted the potential shorter paths and we can't continue.
+                    // If up to this point the nodeTo has been visited, the path exists and the algorithm
+                    // has finished. Otherwise, no path from nodeFrom to nodeTo exists!
+                        terminated = true;
+                        if(nodeTo_was_visited){
+                            path_exists = true;
+                        }else{
+                            path_exists = false;
+                        }
+                    }
+                }
+                path_was_seeked = true;
+
+                // Now, reproduce the path found (if it exists) and store it
+                if(path_exists==true){
+                    reproduce_found_path();
+                }
+                return;
+            }
+
+            bool get_path_was_seeked(){
+                return path_was_seeked;
+            }
+
+            bool get_path_exists(){
+                return path_exists;
+            }
+
+            void print_path(){
                 if(path_was_seeked==true){
-                    open_set.clear();
-                    closed_set.clear();
-                    tentative_costs.clear();
-                    neighbors.clear();
-                    used_queue_elements.clear();
-                    shortest_path.clear();
-                    raw_shortest_path.clear();
-                    path_was_seeked = false;
-                    terminated = false;
-                    path_exists = false;
-                    nodeTo_was_visited = false;
-                    queue = PriorityQueue<numType>();
-                    last_top_of_queue = int_int_and_num_Triad<numType>();
-                    shortest_path_cost = 0;
+                    if(path_exists==true){
+                        cout<<"\n### Shortest path from node "<<nodeFrom<<" to node "<<nodeTo<<":"<<endl;   
+                        cout<<"    "<<nodeFrom<<" (0) -> ";
+                        for(int i=0; i<shortest_path.size(); ++i){
+                            cout<<shortest_path[i].get_value1()<<" ("<<shortest_path[i].get_value2()<<")";
+                            if(i<shortest_path.size()-1){cout<<" -> ";}
+                        }                     
+                        cout<<"\n# Total cost of the path: "<<shortest_path_cost<<endl;
+                    }else{
+                        cout<<"### NO POSSIBLE PATH EXISTS from node "<<nodeFrom<<" to node "<<nodeTo<<" !"<<endl;
+                    }
+                }else{
+                    cout<<"### Shortest path hasn't been seeked yet!"<<endl;
+                }
+                return;
+            }
+
+            vector<int_and_num_Pair<numType>> get_path(){
+                if(path_was_seeked==true){
+                    if(path_exists==true){
+                        return shortest_path;
+                    }else{
+                        cout<<"NO POSSIBLE PATH EXISTS from node "<<nodeFrom<<" to node "<<nodeTo<<" ! Returning empty vector."<<endl;
+                        return vector<int_and_num_Pair<numType>>();
+                    }
+                }else{
+                    cout<<"Shortest path hasn't been seeked yet! Returning empty vector."<<endl;
+                    return vector<int_and_num_Pair<numType>>();
+                }
+            }
+
+            numType get_path_cost(){
+                if(path_was_seeked==true){
+                    if(path_exists==true){
+                        return shortest_path_cost;
+                    }else{
+                        cout<<"NO POSSIBLE PATH EXISTS from node "<<nodeFrom<<" to node "<<nodeTo<<" ! Returning -1."<<endl;
+                        return -1;
+                    }
+                }else{
+                    cout<<"Shortest path hasn't been seeked yet! -1"<<endl;
+                    return -1;
+                }
+            }
+
+            // Shortest path trees and all pairs:
+            // ==================================
+            // seek_path() answers a single (nodeFrom, nodeTo) query. seek_tree() computes, in a single run
+            // of Dijkstra's algorithm with a binary heap, the cost from "source" to every node and the
+            // parent of each node in the shortest path tree (-1 for the source, and for the nodes which
+            // can't be reached, whose cost is "infinity" as in seek_path()).
+            void seek_tree(int source, vector<int> avoid_nodes_with_these_tags=vector<int>()){
+                vector<bool> banned = banned_nodes_of(avoid_nodes_with_these_tags);
+                dijkstra_tree(source, graph.V(), [this](int node){return graph.neighbor_view(node);}, banned,\
+                tree_distances, tree_parents);
+                tree_source = source;
+                return;
+            }
+
+            vector<numType> get_tree_distances(){ // Costs from the source of the last seek_tree()
+                return tree_distances;
+            }
+
+            vector<int> get_tree_parents(){ // Parents in the shortest path tree of the last seek_tree()
+                return tree_parents;
+            }
+
+            vector<int_and_num_Pair<numType>> get_tree_path(int node){ // The path from the source of the last
+            // seek_tree() to "node", in the same format as get_path() (nodes and cost of each step)
+                vector<int_and_num_Pair<numType>> path;
+                if(tree_parents.size()==0 || (tree_parents[node]<0 && node!=tree_source)){
+                    cout<<"NO POSSIBLE PATH EXISTS to node "<<node<<" ! Returning empty vector."<<endl;
+                    return path;
+                }
+                for(int current=node; current!=tree_source; current=tree_parents[current]){
+                    int parent = tree_parents[current];
+                    path.insert(path.begin(), int_and_num_Pair<numType>(current, tree_distances[current]-tree_distances[parent]));
+                }
+                return path;
+            }
+
+            vector<vector<numType>> all_pairs_costs(int n_threads=1, vector<int> avoid_nodes_with_these_tags=vector<int>()){
+                // Cost of the shortest path between every pair of nodes (element [from][to]), by a
+                // seek_tree() from each node. The sources are shared out between n_threads threads. The
+                // neighbors of all nodes are read once before, so the threads only read that copy.
+                int size = graph.V();
+                vector<bool> banned = banned_nodes_of(avoid_nodes_with_these_tags);
+                vector<vector<int_and_num_Pair<numType>>> adjacency;
+                for(int node=0; node<size; ++node){
+                    adjacency.push_back(graph.neighbors(node));
+                }
+                vector<vector<numType>> costs(size);
+                auto worker = [&](int first_source, int step){
+                    vector<int> parents;
+                    for(int source=first_source; source<size; source+=step){
+                        dijkstra_tree(source, size, [&adjacency](int node)->const vector<int_and_num_Pair<numType>>&{\
+                        return adjacency[node];}, banned, costs[source], parents);
+                    }
+                };
+                if(n_threads<=1){
+                    worker(0, 1);
+                }else{
+                    vector<thread> workers;
+                    for(int t=0; t<n_threads; ++t){
+                        workers.push_back(thread(worker, t, n_threads));
+                    }
+                    for(thread& aux : workers){
+                        aux.join();
+                    }
+                }
+                return costs;
+            }
+
+            // A* search:
+            // ==========
+            // seek_path_astar() answers the same query as seek_path(), but the nodes are expanded in order
+            // of cost so far + heuristic(node), where heuristic(node) estimates the cost from node to
+            // nodeTo. If the heuristic never overestimates (it's admissible) and never decreases by more
+            // than the cost of an edge (it's consistent), the path found is a shortest one, and far fewer
+            // nodes are expanded than with Dijkstra's algorithm (which is A* with heuristic 0). The path
+            // is then available through get_path(), get_path_cost() and print_path().
+            template<typename heuristicFunction>
+            void seek_path_astar(int _nodeFrom, int _nodeTo, heuristicFunction heuristic,\
+            vector<int> avoid_nodes_with_these_tags=vector<int>()){
+                int target = _nodeTo;
+                seek_astar(vector<int>(1, _nodeFrom), [target](int node){return node==target;},\
+                [](int, int, numType edge_cost){return edge_cost;}, heuristic, avoid_nodes_with_these_tags);
+                return;
+            }
+
+            template<typename targetFunction, typename stepCostFunction, typename heuristicFunction>
+            numType seek_astar(vector<int> sources, targetFunction is_target, stepCostFunction step_cost,\
+            heuristicFunction heuristic, vector<int> avoid_nodes_with_these_tags=vector<int>()){
+                // General form of A*: several sources, any node for which is_target(node) is true as
+                // destination, and the cost of each step given by step_cost(from, to, edge_cost) (with
+                // from==-1 for the cost of starting on a source). Returns the cost of the path found
+                // (or -1 if no path exists), which is stored as the result of the search.
+                int size = graph.V();
+                vector<bool> banned = banned_nodes_of(avoid_nodes_with_these_tags);
+                vector<numType> costs(size, infinite_cost());
+                vector<int> parents(size, -1);
+                vector<bool> closed(size, false);
+                priority_queue<pair<numType,int>, vector<pair<numType,int>>, greater<pair<numType,int>>> heap; // (By
+                // cost + heuristic)
+                for(int source : sources){
+                    if(!banned[source] && step_cost(-1, source, 0)<costs[source]){
+                        costs[source] = step_cost(-1, source, 0);
+                        heap.push(pair<numType,int>(costs[source]+heuristic(source), source));
+                    }
+                }
+                expanded_nodes = 0;
+                int reached = -1;
+                while(!heap.empty()){
+                    int current = heap.top().second;
+                    heap.pop();
+                    if(closed[current]){
+                        continue;
+                    }
+                    closed[current] = true;
+                    ++expanded_nodes;
+                    if(is_target(current)){
+                        reached = current;
+                        break;
+                    }
+                    for(int_and_num_Pair<numType> neighbor : graph.neighbor_view(current)){
+                        int next = neighbor.get_value1();
+                        if(banned[next] || closed[next]){
+                            continue;
+                        }
+                        numType cost = costs[current]+step_cost(current, next, neighbor.get_value2());
+                        if(cost<costs[next]){
+                            costs[next] = cost;
+                            parents[next] = current;
+                            heap.push(pair<numType,int>(cost+heuristic(next), next));
+                        }
+                    }
+                }
+
+                // Store the result as seek_path() does:
+                shortest_path.clear();
+                path_was_seeked = true;
+                path_exists = (reached>=0);
+                if(!path_exists){
+                    return -1;
+                }
+                int current = reached;
+                while(parents[current]>=0){
+                    shortest_path.insert(shortest_path.begin(),\
+                    int_and_num_Pair<numType>(current, costs[current]-costs[parents[current]]));
+                    current = parents[current];
+                }
+                nodeFrom = current;
+                nodeTo = reached;
+                shortest_path_cost = costs[reached];
+                return shortest_path_cost;
+            }
+
+            long get_expanded_nodes(){ // Nodes expanded by the last A* search
+                return expanded_nodes;
+            }
+
+        private:
+            static numType infinite_cost(){ // (The "infinity" used for the costs of the nodes not reached)
+                return numeric_limits<numType>::infinity()>numeric_limits<numType>::max()?\
+                numeric_limits<numType>::infinity():numeric_limits<numType>::max();
+            }
+
+            vector<bool> banned_nodes_of(vector<int>& avoid_nodes_with_these_tags){
+                vector<bool> banned(graph.V(), false);
+                for(int i=0; i<graph.V() && avoid_nodes_with_these_tags.size()>0; ++i){
+                    int tag_read = graph.get_node_tag(i);
+                    banned[i] = (find(avoid_nodes_with_these_tags.begin(), avoid_nodes_with_these_tags.end(), tag_read)!=\
+                    avoid_nodes_with_these_tags.end());
+                }
+                return banned;
+            }
+
+            template<typename neighborsFunction>
+            static void dijkstra_tree(int source, int size, neighborsFunction neighbors_of, const vector<bool>& banned,\
+            vector<numType>& distances, vector<int>& parents){
+                // Dijkstra's algorithm with a binary heap (std::priority_queue). Instead of decreasing the
+                // key of a node, it's pushed again, and the stale elements are skipped when popped
+                distances.assign(size, infinite_cost());
+                parents.assign(size, -1);
+                if(banned[source]){
+                    return;
+                }
+                vector<bool> settled(size, false);
+                priority_queue<pair<numType,int>, vector<pair<numType,int>>, greater<pair<numType,int>>> heap;
+                distances[source] = 0;
+                heap.push(pair<numType,int>(0, source));
+                while(!heap.empty()){
+                    int current = heap.top().second;
+                    heap.pop();
+                    if(settled[current]){
+                        continue;
+                    }
+                    settled[current] = true;
+                    for(int_and_num_Pair<numType> neighbor : neighbors_of(current)){
+                        int next = neighbor.get_value1();
+                        numType cost = distances[current]+neighbor.get_value2();
+                        if(!banned[next] && !settled[next] && cost<distances[next]){
+                            distances[next] = cost;
+                            parents[next] = current;
+                            heap.push(pair<numType,int>(cost, next));
+                        }
+                    }
+                }
+                return;
+            }
+
+            int_int_and_num_Triad<numType>
+            join_current_and_neighbor_and_cost(int currentNode, int_and_num_Pair<numType> neighbor){
+                return int_int_and_num_Triad<numType>(currentNode, neighbor.get_value1(), neighbor.get_value2());
+            }
+
+            void reproduce_found_path(){
+                // This method examines the vector of used elements of the queue and
+                // extracts the steps done, looking in reverse node order (from nodeTo to
+                // nodeFrom) and choosing those of least total cost. This way, we have
+                // a vector which has, in order, the nodes which conform the shortest path.
+                vector<PriorityQueue<numType>> elements_of_each_destination_node;
+                for(int i=0; i<graph.V(); ++i){ // (graph.V() returns the size of the graph)
+                    elements_of_each_destination_node.push_back(PriorityQueue<numType>());
+                    for(int k=0; k<used_queue_elements.size(); ++k){
+                        if(used_queue_elements[k].get_value2()==i){
+                            elements_of_each_destination_node[i].insert(used_queue_elements[k]);
+                        }
+                    }
+                }
+                // Now, we have to iterate through elements_of_each_destination_node, starting on
+                // elements_of_each_destination_node[nodeTo] and using
+                // elements_of_each_destination_node[nodeTo].get_value1() for next element, and so on:
+                currentNode = nodeTo;
+                int_int_and_num_Triad<numType> rawAux;
+                while(currentNode!=nodeFrom){
+                    rawAux = elements_of_each_destination_node[currentNode].get_top_NotDelete();
+                    raw_shortest_path.insert(raw_shortest_path.begin(), rawAux); // This is insert at the top
+                    currentNode = rawAux.get_value1();
+                }
+                numType previous_cost = 0;
+                numType current_cost = 0;
+                numType step_cost = 0;
+                for(int i=0; i<raw_shortest_path.size(); ++i){
+                    int_and_num_Pair<numType> pairAux;
+                    pairAux.set_value1(raw_shortest_path[i].get_value2());
+                    current_cost = raw_shortest_path[i].get_value3();
+                    step_cost = current_cost - previous_cost;
+                    pairAux.set_value2(step_cost);
+                    shortest_path.push_back(pairAux);
+                    previous_cost = current_cost;
+                }
+                shortest_path_cost = current_cost;
+                return;
+            }
+
+        private:
+            int nodeFrom;
+            int nodeTo;
+            int currentNode;
+            graphType &graph;
+            bool terminated;
+            bool path_was_seeked;
+            bool path_exists;
+            bool nodeTo_was_visited;
+            vector<int> open_set; // Set where to store the still UNVISITED nodes
+            vector<int> closed_set; // Set where to store the VISITED nodes
+            vector<numType> tentative_costs; // Stores the cost it takes from the nodeFrom to each node up to now
+            PriorityQueue<numType> queue;
+            int_int_and_num_Triad<numType> last_top_of_queue;
+            vector<int_int_and_num_Triad<numType>> used_queue_elements; // This will store the elements of the queue which
+            // have been used. This is necessary to reproduce the path found, once the algorithm has finished.
+            vector<int_and_num_Pair<numType>> shortest_path;
+            numType shortest_path_cost;
+            vector<int_int_and_num_Triad<numType>> raw_shortest_path; // Auxiliary vector to store the steps of the path before processing them
+            long expanded_nodes; // Nodes expanded by the last A* search
+            int tree_source; // Source of the last seek_tree()
+            vector<numType> tree_distances; // Costs from tree_source to each node
+            vector<int> tree_parents; // Parent of each node in the shortest path tree (-1 if none)
+    };
+
+    // ===============================================================================================
+    // class Hex_Heuristic
+    // ===============================================================================================
+    class Hex_Heuristic{
+        // Admissible heuristics for A* (ShortestPath::seek_path_astar) on a Hex_Board whose edges cost 1:
+        // - To a node: the hexagonal distance. With the six neighbor steps (dx,dy) of the board
+        //   ((-1,0), (-1,1), (0,-1), (0,1), (1,-1), (1,0)), it's max(|dx|, |dy|, |dx+dy|).
+        // - To a border (to_border): the number of rows (player 1, towards the bottom border) or
+        //   columns (player 2, towards the right border) which are still to be crossed.
+
+        public:
+            Hex_Heuristic(const Hex_Board& board, int target_node):board(board),target_node(target_node),player(0){}
+
+            static Hex_Heuristic to_border(const Hex_Board& board, int player){
+                Hex_Heuristic heuristic(board, -1);
+                heuristic.player = player;
+                return heuristic;
+            }
+
+            int operator()(int node) const{
+                pair<int,int> coords = board.nodeIndex_to_coordinate(node);
+                if(player==1){
+                    return board.get_border_length()-1-coords.first;
+                }else if(player==2){
+                    return board.get_border_length()-1-coords.second;
+                }
+                pair<int,int> target = board.nodeIndex_to_coordinate(target_node);
+                int dx = target.first-coords.first;
+                int dy = target.second-coords.second;
+                return max(max(abs(dx), abs(dy)), abs(dx+dy));
+            }
+
+        private:
+            const Hex_Board& board;
+            int target_node;
+            int player; // 0 (to target_node), or the player whose far border is the target
+    };
+
+    // ===============================================================================================
+    // class Hex_Evaluator
+    // ===============================================================================================
+    class Hex_Evaluator{
+        // Static evaluation of Hex positions by A* searches on the board graph.
+
+        public:
+            static int stones_to_connect(Hex_Board& board, int player){
+                // Minimum number of stones that "player" still has to place to connect their borders (0 if
+                // they're already connected, -1 if the opponent has cut all paths). Entering a cell costs 1
+                // if it's empty and 0 if it's the player's, and the opponent's cells are avoided. As own
+                // stones are free, the heuristic counts the rows (or columns) still to be crossed which
+                // have no stone of the player: each of them needs at least one new stone.
+                int border_length = board.get_border_length();
+                int opponent = (player%2)+1;
+                vector<bool> line_has_stone(border_length, false); // Rows (player 1) or columns (player 2)
+                vector<int> sources;
+                for(int node=0; node<board.V(); ++node){
+                    pair<int,int> coords = board.nodeIndex_to_coordinate(node);
+                    int line = (player==1)?coords.first:coords.second;
+                    if(board.get_node_tag(node)==player){
+                        line_has_stone[line] = true;
+                    }
+                    if(line==0){
+                        sources.push_back(node);
+                    }
+                }
+                vector<int> empty_lines_after(border_length+1, 0); // Lines after each one with no stone of the player
+                for(int line=border_length-1; line>=0; --line){
+                    empty_lines_after[line] = empty_lines_after[line+1]+((line+1<border_length && !line_has_stone[line+1])?1:0);
+                }
+
+                ShortestPath<Hex_Board,int> path(board);
+                int stones = path.seek_astar(sources,
+                    [&](int node){return ((player==1)?board.nodeIndex_to_coordinate(node).first:\
+                    board.nodeIndex_to_coordinate(node).second)==border_length-1;},
+                    [&](int, int to, int){return (board.get_node_tag(to)==player)?0:1;},
+                    [&](int node){return empty_lines_after[(player==1)?board.nodeIndex_to_coordinate(node).first:\
+                    board.nodeIndex_to_coordinate(node).second];},
+                    vector<int>(1, opponent));
+                return stones;
+            }
+    };
+
+    // ===============================================================================================
+    // class Position_Hasher
+    // ===============================================================================================
+    typedef array<uint64_t, 4> Symmetric_Hashes; // Hashes of the 4 symmetric images of a position (see below)
+
+    class Position_Hasher{
+        // Zobrist hashing of Hex positions. The keys are generated from a fixed seed that only depends
+        // on the border length, so that the hash of a position is the same in every run of the program
+        // and it can be saved to disk.
+        // ---------------------------------------------------------------------------------------------
+        // A Hex board has 4 symmetries (every one of them is its own inverse):
+        //      0: identity
+        //      1: 180 degrees rotation, (x,y) -> (N-1-x, N-1-y). It keeps the borders of each player.
+        //      2: transpose plus colour swap, (x,y) -> (y,x) and X <-> O. It maps the borders of player 1
+        //         onto those of player 2, so the stones and the player to move change their colours.
+        //      3: both of them, (x,y) -> (N-1-y, N-1-x) and X <-> O.
+        // Two symmetric positions are equivalent: the player to move wins in one of them if and only if
+        // the player to move wins in the other one. The canonical hash of a position is the least of the
+        // hashes of its 4 images, so that symmetric positions share the same canonical hash.
+        // The hashes of the 4 images are kept together (Symmetric_Hashes), so that they can be updated
+        // incrementally with play().
+
+        public:
+            Position_Hasher(int border_length=11):border_length(border_length){
+                std::mt19937_64 key_generator(0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(border_length));
+                for(int i=0; i<border_length*border_length; ++i){
+                    keys_player_1.push_back(key_generator());
+                    keys_player_2.push_back(key_generator());
+                }
+                key_player_2_to_move = key_generator();
+                // Keys of each stone in each image, so that play() is just a few table lookups:
+                for(int symmetry=0; symmetry<4; ++symmetry){
+                    for(int i=0; i<border_length*border_length; ++i){
+                        int node = transform_node(i, symmetry);
+                        image_keys[symmetry][0].push_back(key(node, transform_player(1, symmetry)));
+                        image_keys[symmetry][1].push_back(key(node, transform_player(2, symmetry)));
+                    }
+                }
+            }
+
+            uint64_t key(int node, int tag) const{ // Key of a stone of player "tag" placed on "node"
+                if(tag==1){
+                    return keys_player_1[node];
+                }else if(tag==2){
+                    return keys_player_2[node];
+                }else{
+                    return 0;
+                }
+            }
+
+            uint64_t side_key(int player_to_move) const{ // Key of the player to move
+                return (player_to_move==2)?key_player_2_to_move:0;
+            }
+
+            int rotate_180(int node) const{ // Index of the node after rotating the board 180 degrees
+                return border_length*border_length-1-node;
+            }
+
+            int transform_node(int node, int symmetry) const{ // Maps a node onto the given symmetric image
+            // of the board. Every symmetry is its own inverse, so this also maps the node back
+                int x = node / border_length;
+                int y = node % border_length;
+                if(symmetry==1){
+                    return rotate_180(node);
+                }else if(symmetry==2){
+                    return y*border_length+x;
+                }else if(symmetry==3){
+                    return (border_length-1-y)*border_length+(border_length-1-x);
+                }else{
+                    return node;
+                }
+            }
+
+            int transform_player(int player, int symmetry) const{ // Colour of "player" in the symmetric image
+                return (symmetry>=2 && player!=0)?(3-player):player;
+            }
+
+            void play(Symmetric_Hashes& hashes, int node, int tag) const{ // Adds (or removes, as it's a XOR)
+            // a stone of player "tag" on "node" to the hashes of the 4 images
+                if(tag==0){
+                    return;
+                }
+                for(int symmetry=0; symmetry<4; ++symmetry){
+                    hashes[symmetry] ^= image_keys[symmetry][tag-1][node];
+                }
+                return;
+            }
+
+            Symmetric_Hashes hash(const Hex_Board& board) const{ // Hashes of the stones of the board and its images
+                Symmetric_Hashes hashes = {0, 0, 0, 0};
+                for(int i=0; i<board.V(); ++i){
+                    if(board.get_node_tag(i)!=0){
+                        play(hashes, i, board.get_node_tag(i));
+                    }
+                }
+                return hashes;
+            }
+
+            uint64_t image_hash(const Symmetric_Hashes& hashes, int player_to_move, int symmetry) const{
+                return hashes[symmetry] ^ side_key(transform_player(player_to_move, symmetry));
+            }
+
+            int canonical_symmetry(const Symmetric_Hashes& hashes, int player_to_move) const{ // Which one of the
+            // images is the canonical one
+                int best = 0;
+                for(int symmetry=1; symmetry<4; ++symmetry){
+                    if(image_hash(hashes, player_to_move, symmetry)<image_hash(hashes, player_to_move, best)){
+                        best = symmetry;
+                    }
+                }
+                return best;
+            }
+
+            uint64_t canonical(const Symmetric_Hashes& hashes, int player_to_move) const{
+                return image_hash(hashes, player_to_move, canonical_symmetry(hashes, player_to_move));
+            }
+
+            uint64_t canonical_hash(const Hex_Board& board, int player_to_move) const{
+                return canonical(hash(board), player_to_move);
+            }
+
+            bool is_rotation_symmetric(const Symmetric_Hashes& hashes) const{ // True if the position is the same
+            // after the 180 degrees rotation. Then each move and its rotated one are equivalent.
+            // (The other symmetries change the player to move, so they never make two moves equivalent)
+                return hashes[1]==hashes[0];
+            }
+
+            int get_border_length() const{
+                return border_length;
+            }
+
+        private:
+            int border_length;
+            vector<uint64_t> keys_player_1;
+            vector<uint64_t> keys_player_2;
+            uint64_t key_player_2_to_move;
+            vector<uint64_t> image_keys[4][2]; // image_keys[symmetry][player-1][node]
+    };
+
+    // ===============================================================================================
+    // class Hex_Solver
+    // ===============================================================================================
+    class Hex_Solver{
+        // Exact solver for small boards, based on depth-first proof-number search (DF-PN). Given a
+        // position and the player to move, it tries to prove that such player wins in all lines
+        // (proof number = 0) or loses in all lines (disproof number = 0). Notice that there are no
+        // draws in Hex, so both things can't happen at the same time and one of them is always true.
+        // ---------------------------------------------------------------------------------------------
+        // Proof and disproof numbers are stored in a transposition table keyed by the canonical hash
+        // of the positions. Every position which gets solved is also stored in a cache which is kept
+        // between calls to solve() (and between runs of the program, by using save_cache() and
+        // load_cache()), so that the work done on previous moves of the game is not repeated.
+        // If the node budget is exhausted before solving the position, SOLVER_UNKNOWN is returned.
+
+        public:
+            Hex_Solver(int border_length=7, long max_nodes=SOLVER_MAX_NODES):border_length(border_length),\
+            max_nodes(max_nodes),hasher(border_length),nodes_searched(0),aborted(false),winning_move(-1),\
+            visit_stamp(0){}
+
+            solverResult solve(Hex_Board& board, int player_to_move){
+                if(board.get_border_length()!=border_length){
+                    cout<<"The solver was built for a "<<border_length<<" x "<<border_length<<" board. Returning unknown."<<endl;
+                    return SOLVER_UNKNOWN;
+                }
+                if(neighbors_of.size()==0){
+                    build_tables(board);
+                }
+
+                // Copy the stones of the board and begin the search:
+                for(int i=0; i<board.V(); ++i){
+                    cells[i] = board.get_node_tag(i);
+                }
+                transposition_table.clear();
+                nodes_searched = 0;
+                aborted = false;
+                winning_move = -1;
+                Symmetric_Hashes hashes = hasher.hash(board);
+                mid(player_to_move, hashes, INF, INF);
+
+                uint32_t pn, dn;
+                lookup(hasher.canonical(hashes, player_to_move), pn, dn);
+                if(pn==0){
+                    find_winning_move(player_to_move, hashes);
+                    return SOLVER_WIN;
+                }else if(dn==0){
+                    return SOLVER_LOSS;
+                }else{
+                    return SOLVER_UNKNOWN;
+                }
+            }
+
+            int get_winning_move() const{ // Returns the node to play if the last solve() returned SOLVER_WIN
+                return winning_move;
+            }
+
+            long get_nodes_searched() const{
+                return nodes_searched;
+            }
+
+            int get_cache_size() const{
+                return solved_positions.size();
+            }
+
+            bool save_cache(string filename) const{
+                // File format: the characters "HEXSOLV2", the border length (int32), the number of
+                // entries (uint64) and then, for each entry, its canonical hash (uint64) and its result
+                // for the player to move (int8, 1 means win and -1 means loss)
+                ofstream file(filename, ios::binary);
+                if(!file){
+                    cout<<"Solver cache couldn't be saved to "<<filename<<endl;
+                    return false;
+                }
+                int32_t bl = border_length;
+                uint64_t n_entries = solved_positions.size();
+                file.write("HEXSOLV2", 8);
+                file.write(reinterpret_cast<const char*>(&bl), sizeof(bl));
+                file.write(reinterpret_cast<const char*>(&n_entries), sizeof(n_entries));
+                for(auto& entry : solved_positions){
+                    file.write(reinterpret_cast<const char*>(&entry.first), sizeof(entry.first));
+                    file.write(reinterpret_cast<const char*>(&entry.second), sizeof(entry.second));
+                }
+                return true;
+            }
+
+            bool load_cache(string filename){ // Adds the entries of a cache file to the cache. Returns false if
+            // the file doesn't exist or doesn't belong to this board size
+                ifstream file(filename, ios::binary);
+                if(!file){
+                    return false;
+                }
+                char magic[8];
+                int32_t bl = 0;
+                uint64_t n_entries = 0;
+                file.read(magic, 8);
+                file.read(reinterpret_cast<char*>(&bl), sizeof(bl));
+                file.read(reinterpret_cast<char*>(&n_entries), sizeof(n_entries));
+                if(!file || string(magic, 8)!="HEXSOLV2" || bl!=border_length){
+                    cout<<"File "<<filename<<" isn't a solver cache for a "<<border_length<<" x "<<border_length<<" board. Ignoring it."<<endl;
+                    return false;
+                }
+                for(uint64_t k=0; k<n_entries; ++k){
+                    uint64_t key;
+                    int8_t result;
+                    file.read(reinterpret_cast<char*>(&key), sizeof(key));
+                    file.read(reinterpret_cast<char*>(&result), sizeof(result));
+                    if(!file){
+                        break;
+                    }
+                    solved_positions[key] = result;
+                }
+                return true;
+            }
+
+        private:
+            void build_tables(Hex_Board& board){ // Precomputes the neighbors of each cell, the borders and the
+            // order in which the moves are tried (closest to the center first)
+                int size = board.V();
+                cells.assign(size, 0);
+                visited.assign(size, 0);
+                for(int i=0; i<size; ++i){
+                    vector<int> aux;
+                    board.for_each_neighbor(i, [&aux](int neighbor, int){aux.push_back(neighbor);});
+                    neighbors_of.push_back(aux);
+                    move_order.push_back(i);
+                }
+                int center = border_length-1; // (Coordinates are doubled to keep integers)
+                auto distance_to_center = [&](int node){
+                    int dx = 2*(node/border_length)-center;
+                    int dy = 2*(node%border_length)-center;
+                    return abs(dx)+abs(dy)+abs(dx+dy);
+                };
+                stable_sort(move_order.begin(), move_order.end(), [&](int a, int b){
+                    return distance_to_center(a)<distance_to_center(b);
+                });
+                return;
+            }
+
+            bool connects(int node, int player){ // Checks whether the group of stones of "player" which contains
+            // "node" touches both borders of that player (top and bottom for player 1, left and right for player 2)
+                ++visit_stamp;
+                bool touches_first = false;
+                bool touches_second = false;
+                stack.clear();
+                stack.push_back(node);
+                visited[node] = visit_stamp;
+                while(stack.size()>0){
+                    int current = stack.back();
+                    stack.pop_back();
+                    int coord = (player==1)?(current/border_length):(current%border_length);
+                    if(coord==0){touches_first = true;}
+                    if(coord==border_length-1){touches_second = true;}
+                    if(touches_first && touches_second){
+                        return true;
+                    }
+                    for(int next : neighbors_of[current]){
+                        if(cells[next]==player && visited[next]!=visit_stamp){
+                            visited[next] = visit_stamp;
+                            stack.push_back(next);
+                        }
+                    }
+                }
+                return false;
+            }
+
+            void lookup(uint64_t key, uint32_t &pn, uint32_t &dn) const{
+                auto solved = solved_positions.find(key);
+                if(solved!=solved_positions.end()){
+                    pn = (solved->second==1)?0:INF;
+                    dn = (solved->second==1)?INF:0;
+                    return;
+                }
+                auto entry = transposition_table.find(key);
+                if(entry!=transposition_table.end()){
+                    pn = entry->second.first;
+                    dn = entry->second.second;
+                }else{
+                    pn = 1;
+                    dn = 1;
+                }
+                return;
+            }
+
+            void store(uint64_t key, uint32_t pn, uint32_t dn){
+                if(pn==0){
+                    solved_positions[key] = 1;
+                }else if(dn==0){
+                    solved_positions[key] = -1;
+                }else{
+                    transposition_table[key] = pair<uint32_t,uint32_t>(pn, dn);
+                }
+                return;
+            }
+
+            void mid(int mover, const Symmetric_Hashes& hashes, uint32_t th_pn, uint32_t th_dn){
+                // Multiple iterative deepening at a node whose player to move is "mover". The node is
+                // expanded until its proof number reaches th_pn or its disproof number reaches th_dn.
+                // This is the negamax formulation: the proof number of a node is the least disproof
+                // number of its children, and its disproof number is the sum of the children's proof numbers
+                uint64_t key = hasher.canonical(hashes, mover);
+                ++nodes_searched;
+                if(nodes_searched>max_nodes){
+                    aborted = true;
+                    return;
+                }
+
+                // Generate the moves. If any of them connects the mover's borders, the node is proved.
+                // If the position is symmetric under the 180 degrees rotation, only one move of each
+                // pair of rotated moves is generated, as both of them lead to equivalent positions
+                bool symmetric = hasher.is_rotation_symmetric(hashes);
+                vector<int> moves;
+                for(int node : move_order){
+                    if(cells[node]==0 && (!symmetric || node<=hasher.rotate_180(node))){
+                        moves.push_back(node);
+                    }
+                }
+                for(int node : moves){
+                    cells[node] = mover;
+                    bool wins = connects(node, mover);
+                    cells[node] = 0;
+                    if(wins){
+                        store(key, 0, INF);
+                        return;
+                    }
+                }
+
+                int opponent = (mover%2)+1;
+                vector<Symmetric_Hashes> children_hashes;
+                for(int node : moves){
+                    Symmetric_Hashes aux = hashes;
+                    hasher.play(aux, node, mover);
+                    children_hashes.push_back(aux);
+                }
+
+                while(true){
+                    uint32_t pn = INF;
+                    uint32_t dn = 0;
+                    uint32_t second_dn = INF;
+                    uint32_t best_child_pn = 0;
+                    int best = -1;
+                    for(int i=0; i<moves.size(); ++i){
+                        uint32_t child_pn, child_dn;
+                        lookup(hasher.canonical(children_hashes[i], opponent), child_pn, child_dn);
+                        dn = min(INF, dn+child_pn);
+                        if(best<0 || child_dn<pn){
+                            second_dn = pn;
+                            pn = child_dn;
+                            best_child_pn = child_pn;
+                            best = i;
+                        }else if(child_dn<second_dn){
+                            second_dn = child_dn;
+                        }
+                    }
+                    if(pn>=th_pn || dn>=th_dn || aborted){
+                        if(!aborted){store(key, pn, dn);}
+                        return;
+                    }
+                    uint32_t child_th_pn = (th_dn>=INF)?INF:min(INF, th_dn-dn+best_child_pn);
+                    uint32_t child_th_dn = (second_dn>=INF)?th_pn:min(th_pn, second_dn+1);
+                    cells[moves[best]] = mover;
+                    mid(opponent, children_hashes[best], child_th_pn, child_th_dn);
+                    cells[moves[best]] = 0;
+                }
+            }
+
+            void find_winning_move(int mover, const Symmetric_Hashes& hashes){
+                // The root is proved: look for a move which connects at once or whose resulting
+                // position is a loss for the opponent
+                int opponent = (mover%2)+1;
+                for(int node : move_order){
+                    if(cells[node]!=0){
+                        continue;
+                    }
+                    cells[node] = mover;
+                    bool wins = connects(node, mover);
+                    cells[node] = 0;
+                    uint32_t child_pn, child_dn;
+                    Symmetric_Hashes child_hashes = hashes;
+                    hasher.play(child_hashes, node, mover);
+                    lookup(hasher.canonical(child_hashes, opponent), child_pn, child_dn);
+                    if(wins || child_dn==0){
+                        winning_move = node;
+                        return;
+                    }
+                }
+                return;
+            }
+
+        private:
+            static uint32_t const INF = 100000000; // "Infinite" proof or disproof number
+            int border_length;
+            long max_nodes;
+            Position_Hasher hasher;
+            long nodes_searched;
+            bool aborted; // True if the node budget was exhausted during the last search
+            int winning_move;
+            vector<int> cells; // Stones of the position being searched (0 empty, 1 player 1, 2 player 2)
+            vector<vector<int>> neighbors_of;
+            vector<int> move_order;
+            vector<int> visited; // Auxiliary vectors for the connection checks
+            vector<int> stack;
+            int visit_stamp;
+            unordered_map<uint64_t, pair<uint32_t,uint32_t>> transposition_table; // Proof and disproof numbers of
+            // the unsolved positions of the current search
+            unordered_map<uint64_t, int8_t> solved_positions; // Solved positions (1 win, -1 loss for the player to move)
+    };
+
+    // ===============================================================================================
+    // class Swap_Map
+    // ===============================================================================================
+    class Swap_Map{
+        // Precomputed swap decisions of the bot. When player 1 moves first and the swap rule is enabled,
+        // the bot (player 2) decides at move 2 whether to capture player 1's first move. For each board
+        // size covered here there is a map with one character per node (in node index order): 'S' if
+        // the bot should swap when player 1's first move is on that node, and '.' otherwise.
+        // The maps are computed offline with the option --build-swap-map of the program. Only the sizes
+        // that Hex_Solver settles exactly are covered: a Monte Carlo map compares one noisy ratio (the
+        // swap) against the best of N*N noisy ratios, so it's biased and changes from one run to another.
+        // For the sizes which aren't covered, the bot decides by simulation during the game.
+
+        public:
+            static int decision(int border_length, int first_move){ // Returns 1 if the bot should swap, 0 if it
+            // shouldn't, and -1 if this board size isn't covered by the precomputed maps
+                const char* cells = map_of_size(border_length);
+                if(cells==nullptr || first_move<0 || first_move>=border_length*border_length){
+                    return -1;
+                }
+                return (cells[first_move]=='S')?1:0;
+            }
+
+        private:
+            static const char* map_of_size(int border_length){
+                static pair<int, const char*> const maps[] = {
+                    // Exact (Hex_Solver):
+                    {3, ".SS.S.SS."},
+                    {4, "...S..S..S..S..."}
+                };
+                for(auto& entry : maps){
+                    if(entry.first==border_length){
+                        return entry.second;
+                    }
+                }
+                return nullptr;
+            }
+    };
+
+    // ===============================================================================================
+    // class Pattern_Policy
+    // ===============================================================================================
+    class Pattern_Policy{
+        // Fast move prior based on local patterns. The pattern of a cell is the content of its 6
+        // neighbors, each one being empty (0), X (1), O (2) or outside the board (3), so there are
+        // 4^6 = 4096 patterns. The code of a pattern is the sum of content*4^d over the directions d:
+        //      d:        0        1        2        3        4        5
+        //      (dx,dy): (-1,0)   (-1,1)   (0,-1)   (0,1)    (1,-1)   (1,0)
+        // (the same six neighbors as in the Hex_Board graph; the opposite of direction d is 5-d).
+        // Each pattern has a weight, learned offline from self-play games (see Pattern_Trainer), which
+        // measures how much more often than average the engine chose a move with that pattern.
+        // Weights are stored from the point of view of player 1. For player 2, the pattern is mapped by
+        // the transpose plus colour swap symmetry (see Position_Hasher), so one table serves both.
+        // The random games draw their moves with integer weights (see Weight_Tree), so each weight is also
+        // kept for each player in units of 1/WEIGHT_SCALE (at least 1, so that every cell can be drawn).
+
+        public:
+            static int const N_DIRECTIONS = 6;
+            static int const N_PATTERNS = 4096;
+            static constexpr double WEIGHT_SCALE = 65536;
+
+            Pattern_Policy():loaded(false){
+                weights.assign(N_PATTERNS, 1.0f);
+                int transposed_direction[N_DIRECTIONS] = {2, 4, 0, 5, 1, 3};
+                for(int code=0; code<N_PATTERNS; ++code){
+                    int mirror_code = 0;
+                    for(int d=0; d<N_DIRECTIONS; ++d){
+                        int content = (code>>(2*d))&3;
+                        if(content==1 || content==2){
+                            content = 3-content;
+                        }
+                        mirror_code += content<<(2*transposed_direction[d]);
+                    }
+                    mirror.push_back(mirror_code);
+                }
+                scale_weights();
+            }
+
+            static int direction_dx(int d){
+                int const dx[N_DIRECTIONS] = {-1, -1, 0, 0, 1, 1};
+                return dx[d];
+            }
+
+            static int direction_dy(int d){
+                int const dy[N_DIRECTIONS] = {0, 1, -1, 1, -1, 0};
+                return dy[d];
+            }
+
+            float weight(int code, int player) const{ // Weight of a move of "player" on a cell with pattern "code"
+                return weights[(player==1)?code:mirror[code]];
+            }
+
+            int64_t scaled_weight(int code, int player) const{ // The same, in units of 1/WEIGHT_SCALE
+                return scaled_weights[(player-1)*N_PATTERNS+code];
+            }
+
+            bool is_loaded() const{ // False while the weights are the default ones (all equal to 1)
+                return loaded;
+            }
+
+            void set_weights(vector<float> new_weights){
+                if(new_weights.size()!=N_PATTERNS){
+                    cout<<"A pattern policy needs "<<N_PATTERNS<<" weights. Nothing has been done."<<endl;
+                    return;
+                }
+                weights = new_weights;
+                loaded = true;
+                scale_weights();
+                return;
+            }
+
+            static string default_filename(){ // (Patterns are local, so the same weights serve for every board size)
+                return "hex_patterns.bin";
+            }
+
+            bool save(string filename) const{ // File format: "HEXPAT01" followed by the 4096 weights (float32)
+                ofstream file(filename, ios::binary);
+                if(!file){
+                    cout<<"Pattern weights couldn't be saved to "<<filename<<endl;
+                    return false;
+                }
+                file.write("HEXPAT01", 8);
+                file.write(reinterpret_cast<const char*>(weights.data()), N_PATTERNS*sizeof(float));
+                return true;
+            }
+
+            bool load(string filename){
+                ifstream file(filename, ios::binary);
+                if(!file){
+                    return false;
+                }
+                char magic[8];
+                vector<float> aux(N_PATTERNS);
+                file.read(magic, 8);
+                file.read(reinterpret_cast<char*>(aux.data()), N_PATTERNS*sizeof(float));
+                if(!file || string(magic, 8)!="HEXPAT01"){
+                    cout<<"File "<<filename<<" isn't a pattern weights file. Ignoring it."<<endl;
+                    return false;
+                }
+                set_weights(aux);
+                return true;
+            }
+
+        private:
+            void scale_weights(){
+                scaled_weights.assign(2*N_PATTERNS, 1);
+                for(int player=1; player<=2; ++player){
+                    for(int code=0; code<N_PATTERNS; ++code){
+                        scaled_weights[(player-1)*N_PATTERNS+code] = max<int64_t>(1, llround(weight(code, player)*WEIGHT_SCALE));
+                    }
+                }
+                return;
+            }
+
+            vector<float> weights;
+            vector<int> mirror; // Code of each pattern after the transpose plus colour swap
+            vector<int64_t> scaled_weights; // scaled_weights[(player-1)*N_PATTERNS+code]
+            bool loaded;
+    };
+
+    // ===============================================================================================
+    // class Pattern_Codes
+    // ===============================================================================================
+    class Pattern_Codes{
+        // Pattern codes (see Pattern_Policy) of every cell of a board. They are computed once and then
+        // kept up to date as stones are placed: a stone only changes the codes of its 6 neighbors, so
+        // the pattern of any cell is always available in O(1).
+
+        public:
+            Pattern_Codes():border_length(0){}
+
+            template<typename boardType> // (Hex_Board or Position)
+            Pattern_Codes(const boardType& board):border_length(0){
+                reset(board);
+            }
+
+            template<typename boardType>
+            void reset(const boardType& board){ // Computes the codes of board. (The neighbor table and the
+            // buffers are only rebuilt if the board size changes, so one object can be reused for many games)
+                if(border_length!=board.get_border_length()){
+                    border_length = board.get_border_length();
+                    neighbor_in_direction.clear();
+                    for(int node=0; node<board.V(); ++node){
+                        int x = node/border_length;
+                        int y = node%border_length;
+                        for(int d=0; d<Pattern_Policy::N_DIRECTIONS; ++d){
+                            int nx = x+Pattern_Policy::direction_dx(d);
+                            int ny = y+Pattern_Policy::direction_dy(d);
+                            bool outside = (nx<0 || nx>=border_length || ny<0 || ny>=border_length);
+                            neighbor_in_direction.push_back(outside?-1:nx*border_length+ny);
+                        }
+                    }
+                }
+                codes.assign(board.V(), 0);
+                for(int node=0; node<board.V(); ++node){
+                    for(int d=0; d<Pattern_Policy::N_DIRECTIONS; ++d){
+                        int neighbor = neighbor_in_direction[node*Pattern_Policy::N_DIRECTIONS+d];
+                        codes[node] += ((neighbor<0)?3:board.get_node_tag(neighbor))<<(2*d);
+                    }
+                }
+                return;
+            }
+
+            void play(int node, int player){ // Updates the codes of the neighbors of "node" when a stone of
+            // "player" is placed on it
+                for(int d=0; d<Pattern_Policy::N_DIRECTIONS; ++d){
+                    int neighbor = neighbor_in_direction[node*Pattern_Policy::N_DIRECTIONS+d];
+                    if(neighbor>=0){
+                        codes[neighbor] += player<<(2*(Pattern_Policy::N_DIRECTIONS-1-d)); // (Seen from the
+                        // neighbor, "node" is in the opposite direction)
+                    }
+                }
+                return;
+            }
+
+            int code(int node) const{
+                return codes[node];
+            }
+
+            int neighbor(int node, int d) const{ // The neighbor of node in direction d (-1 if outside the board)
+                return neighbor_in_direction[node*Pattern_Policy::N_DIRECTIONS+d];
+            }
+
+        private:
+            int border_length;
+            vector<int> codes;
+            vector<int> neighbor_in_direction; // neighbor_in_direction[node*6+d], or -1 if outside the board
+    };
+
+    // ===============================================================================================
+    // class Weight_Tree
+    // ===============================================================================================
+    class Weight_Tree{
+        // Sum tree of non-negative integer weights, to draw an index with probability proportional to its
+        // weight, and to change a weight, both in O(log n) (for the pattern-weighted random games, see
+        // MonteCarlo_Bot::order_for_playout). Each node has up to 16 children, so the tree is shallow (2
+        // levels on an 11x11 board, 4 on the largest ones): a draw scans at most 16 sums per level and a
+        // change updates one sum per level. The weights are integers so that the sums stay exact however
+        // many times they're changed.
+
+        public:
+            static int const FAN_OUT_BITS = 4;
+            static size_t const FAN_OUT = 1<<FAN_OUT_BITS; // (16 children)
+
+            void assign(const vector<int64_t>& new_weights){ // O(n). (The buffers of the levels are reused)
+                int n_levels = 1;
+                for(size_t size=new_weights.size(); size>FAN_OUT; size=(size+FAN_OUT-1)/FAN_OUT){
+                    ++n_levels;
+                }
+                levels.resize(n_levels);
+                levels[0] = new_weights;
+                for(int k=0; k<n_levels; ++k){
+                    levels[k].resize((levels[k].size()+FAN_OUT-1)/FAN_OUT*FAN_OUT, 0); // (Whole groups of children)
+                    if(k+1<n_levels){
+                        levels[k+1].assign(levels[k].size()/FAN_OUT, 0);
+                        for(size_t i=0; i<levels[k].size(); ++i){
+                            levels[k+1][i/FAN_OUT] += levels[k][i];
+                        }
+                    }
+                }
+                return;
+            }
+
+            void set(int index, int64_t weight){
+                int64_t delta = weight-levels[0][index];
+                for(size_t k=0; k<levels.size(); ++k){
+                    levels[k][index>>(FAN_OUT_BITS*k)] += delta;
                 }
+                return;
+            }
 
-                // Set these two variables:
-                nodeFrom = _nodeFrom;
-                nodeTo = _nodeTo;
+            int64_t get(int index) const{
+                return levels[0][index];
+            }
+
+            int64_t get_total() const{
+                int64_t total = 0;
+                for(int64_t sum : levels.back()){
+                    total += sum;
+                }
+                return total;
+            }
+
+            int find(int64_t r) const{ // The index whose share of the total contains r (0 <= r < total)
+                int index = 0;
+                for(int k=levels.size()-1; k>=0; --k){
+                    // The chosen child is the first one whose running sum exceeds r. All of the 16 children are
+                    // scanned without branches, as the position of the chosen one is random
+                    const int64_t* sums = levels[k].data()+(index<<FAN_OUT_BITS); // (index is 0 on the top level)
+                    int64_t running_sum = 0;
+                    int64_t skipped_sum = 0;
+                    int n_skipped = 0;
+                    for(size_t j=0; j<FAN_OUT; ++j){
+                        running_sum += sums[j];
+                        bool skip = (running_sum<=r);
+                        n_skipped += skip;
+                        skipped_sum += skip?sums[j]:0;
+                    }
+                    index = (index<<FAN_OUT_BITS)+n_skipped;
+                    r -= skipped_sum;
+                }
+                return index;
+            }
+
+        private:
+            vector<vector<int64_t>> levels; // levels[0] are the weights, levels[k+1][i] the sum of the 16
+            // children levels[k][16*i...16*i+15], up to a single group of 16 sums. (Padded with zeros)
+    };
+
+    // ===============================================================================================
+    // class MonteCarlo_Bot
+    // ===============================================================================================
+    struct Bot_Move{ // A move chosen by MonteCarlo_Bot::choose_move()
+        int node = -1; // (For a swap, the node of player 1's first move)
+        bool is_swap = false;
+        double ratio = -1; // Estimated ratio of victories of the bot (-1 if the swap map decided the swap)
+        vector<pair<int, double>> nodes_and_ratios; // The ratios of the candidates (empty if not simulated)
+    };
+
+    class MonteCarlo_Bot{
+        // The Monte Carlo engine of the bot opponent (player 2, "O"). For each possible move, it plays
+        // random games until the board is full (n_iterations per move on average), and counts how many
+        // of them the bot wins.
+        // It doesn't depend on the game flow, so it can be used both by Hex_Game and by offline tools
+        // such as the opening book generator.
+
+        public:
+            MonteCarlo_Bot(bool swap_rule=false, int n_iterations=N_MC_ITERATIONS):swap_rule(swap_rule),\
+            n_iterations(n_iterations),policy(nullptr),random_generator(gen()),\
+            use_sequential_halving(SEQUENTIAL_HALVING),use_early_cutoff(EARLY_PLAYOUT_CUTOFF),n_cut_playouts(0),\
+            n_playout_moves(0),halving_survivor(-1){}
+
+            void set_seed(uint32_t seed){ // Each bot draws its random games from its own generator, so that
+            // several bots can play at the same time on different threads
+                random_generator.seed(seed);
+                return;
+            }
+
+            void set_policy(const Pattern_Policy* pattern_policy){ // With a loaded pattern policy, the random games
+            // choose their moves with probability proportional to the pattern weights instead of uniformly
+                policy = pattern_policy;
+                return;
+            }
+
+            void order_for_playout(vector<int>& shufflable, const Position& aux_position, int next_player){
+                // Sets the order in which the nodes of "shufflable" will be played in a random game on
+                // aux_position, starting with "next_player" and alternating. Without pattern policy, it's
+                // a uniform shuffle. With it, each move is drawn with probability proportional to the
+                // weight of its pattern for the player who makes it, updating the patterns incrementally.
+                // (Nodes of shufflable which are already occupied are left at the end)
+                if(policy==nullptr || !policy->is_loaded()){
+                    shuffle(begin(shufflable), end(shufflable), random_generator); // Shuffle the vector in a random order
+                    return;
+                }
+                // The weights of the empty cells are kept in a Weight_Tree for each player, so a move is drawn
+                // in O(log E), and a stone only changes the weights of its (up to 6) empty neighbors
+                playout_codes.reset(aux_position);
+                playout_occupied.clear();
+                for(int player=1; player<=2; ++player){
+                    playout_weights[player-1].assign(aux_position.V(), 0);
+                }
+                int n_remaining = 0;
+                for(int node : shufflable){
+                    if(aux_position.get_node_tag(node)==0){
+                        for(int player=1; player<=2; ++player){
+                            playout_weights[player-1][node] = policy->scaled_weight(playout_codes.code(node), player);
+                        }
+                        ++n_remaining;
+                    }else{
+                        playout_occupied.push_back(node);
+                    }
+                }
+                for(int player=1; player<=2; ++player){
+                    playout_trees[player-1].assign(playout_weights[player-1]);
+                }
+                shufflable.clear();
+                int player = next_player;
+                for(; n_remaining>0; --n_remaining){
+                    Weight_Tree& tree = playout_trees[player-1];
+                    int node = tree.find(uniform_int_distribution<int64_t>(0, tree.get_total()-1)(random_generator));
+                    playout_trees[0].set(node, 0);
+                    playout_trees[1].set(node, 0);
+                    shufflable.push_back(node);
+                    playout_codes.play(node, player);
+                    for(int d=0; d<Pattern_Policy::N_DIRECTIONS; ++d){
+                        int neighbor = playout_codes.neighbor(node, d);
+                        if(neighbor>=0 && playout_trees[0].get(neighbor)>0){ // (Still to be played)
+                            playout_trees[0].set(neighbor, policy->scaled_weight(playout_codes.code(neighbor), 1));
+                            playout_trees[1].set(neighbor, policy->scaled_weight(playout_codes.code(neighbor), 2));
+                        }
+                    }
+                    player = (player%2)+1;
+                }
+                for(int node : playout_occupied){
+                    shufflable.push_back(node);
+                }
+                return;
+            }
+
+            vector<double> prior_bias(const Position& board){ // Progressive bias of each node for a bot move: the
+            // pattern weight (relative to the best candidate) times PRIOR_BIAS_WEIGHT, divided by the number
+            // of simulations + 1. It's added to the ratios of victories when choosing the move, so it only
+            // decides between moves whose ratios are almost equal. All zeros without pattern policy
+                vector<double> bias(board.V(), 0.0);
+                if(policy==nullptr || !policy->is_loaded()){
+                    return bias;
+                }
+                Pattern_Codes codes(board);
+                vector<int> unused_nodes = get_unused_nodes(board);
+                double max_weight = 0;
+                for(int node : unused_nodes){
+                    max_weight = max(max_weight, static_cast<double>(policy->weight(codes.code(node), 2)));
+                }
+                for(int node : unused_nodes){
+                    bias[node] = PRIOR_BIAS_WEIGHT*policy->weight(codes.code(node), 2)/max_weight/(n_iterations+1);
+                }
+                return bias;
+            }
+
+            vector<int> get_unused_nodes(const Position& board){ // Nodes that haven't been played yet
+                vector<int> unused_nodes;
+                for(int i=0; i<board.V(); ++i){
+                    if(board.get_node_tag(i)==0){
+                        unused_nodes.push_back(i);
+                    }
+                }
+                return unused_nodes;
+            }
+
+            bool check_bot_won(const Position& position){ // Special "check_connection_lateral" method, for the bot's implementation
+                // Check if the stones of player 2 ("O") connect the West and East borders
+                return Engine_Dispatcher::has_connection(position, 2);
+            }
+
+            bool check_bot_won(const Hex_Board& board){
+                return check_bot_won(Position(board, 1));
+            }
+
+            vector<pair<int, double>> monte_carlo_ratios(const Hex_Board& board, int this_is_movement_number){
+                return monte_carlo_ratios(Position(board, 2), this_is_movement_number);
+            }
+
+            double monte_carlo_ratio_with_swap(const Hex_Board& board, int player1_first_move){
+                return monte_carlo_ratio_with_swap(Position(board, 2), player1_first_move);
+            }
+
+            vector<pair<int, double>> monte_carlo_ratios(const Game_State& state, int this_is_movement_number){
+                // (The empty cells are already known by the game state)
+                return monte_carlo_ratios(state.get_position(), state.get_empty_cells(), this_is_movement_number);
+            }
+
+            vector<pair<int, double>> monte_carlo_ratios(const Position& board, int this_is_movement_number){
+                return monte_carlo_ratios(board, get_unused_nodes(board), this_is_movement_number);
+            }
+
+            vector<pair<int, double>> monte_carlo_ratios(const Position& board, const vector<int>& unused_nodes,\
+            int this_is_movement_number){
+                // For each possible movement of the bot (player 2), run random games and return the ratio of
+                // bot victories. The random games are played on a copy of the position (just its stones),
+                // which is reset at the start of each one.
+                // If the position is the same after rotating the board 180 degrees, a move and its rotated
+                // one are equivalent, so only one of them is simulated and its ratio is given to both.
+                // Without sequential halving, every candidate gets n_iterations random games. With it, the
+                // same total (n_iterations per candidate) is shared out in rounds (see sequential_halving()),
+                // and the move to play is the one which survives them (see best_candidate())
+                halving_survivor = -1;
+                vector<int> shufflable = unused_nodes;
+                bool symmetric = is_rotation_symmetric(board);
+                Position aux_position(board);
+                vector<int> candidates;
+                for(auto fixed_possible_node : unused_nodes){
+                    if(!(symmetric && board.V()-1-fixed_possible_node<fixed_possible_node)){ // (Otherwise it's
+                    // simulated as the rotation of another move)
+                        candidates.push_back(fixed_possible_node);
+                    }
+                }
+                vector<double> ratios(candidates.size(), 0);
+                vector<long> games(candidates.size(), n_iterations);
+                if(use_sequential_halving && candidates.size()>1){
+                    ratios = sequential_halving(board, candidates, prior_bias(board), games, shufflable, aux_position,\
+                    this_is_movement_number);
+                }else{
+                    for(int k=0; k<candidates.size(); ++k){
+                        ratios[k] = static_cast<double>(random_games(board, candidates[k], n_iterations, shufflable,\
+                        aux_position, this_is_movement_number))/n_iterations;
+                    }
+                }
+
+                // Save the results of Monte Carlo runs for each candidate (and its rotated node):
+                vector<pair<int, double>> nodes_and_ratios;
+                candidate_games.assign(board.V(), 0);
+                for(int k=0; k<candidates.size(); ++k){
+                    int rotated_node = board.V()-1-candidates[k];
+                    nodes_and_ratios.push_back(pair<int,double>(candidates[k],ratios[k]));
+                    candidate_games[candidates[k]] = games[k];
+                    if(symmetric && rotated_node!=candidates[k]){
+                        nodes_and_ratios.push_back(pair<int,double>(rotated_node,ratios[k]));
+                        candidate_games[rotated_node] = games[k];
+                    }
+                }
+                return nodes_and_ratios;
+            }
+
+            vector<double> sequential_halving(const Position& board, const vector<int>& candidates,\
+            const vector<double>& bias, vector<long>& games, vector<int>& shufflable, Position& aux_position,\
+            int this_is_movement_number){ // (games receives the random games played by each candidate)
+                // Sequential halving: the budget of n_iterations random games per candidate is split into
+                // ceil(log2(candidates)) rounds. In each round, the candidates still in the race share the
+                // budget of the round equally, and then the worse half of them (by ratio of victories over
+                // all of their games) is dropped. So the obviously bad moves get few games and the best ones
+                // get most of the budget, which tells them apart much better for the same total.
+                // The candidates are ranked by ratio plus prior bias (see prior_bias()). Every candidate keeps
+                // its own ratio, so a dropped one, with few games, may have a higher ratio than the survivor:
+                // the survivor is kept in halving_survivor, and that's the move to play.
+                long budget = static_cast<long>(n_iterations)*candidates.size();
+                int n_rounds = static_cast<int>(ceil(log2(static_cast<double>(candidates.size()))));
+                vector<long> victories(candidates.size(), 0);
+                games.assign(candidates.size(), 0);
+                vector<double> ratios(candidates.size(), 0);
+                vector<int> alive(candidates.size()); // (Indices in candidates)
+                for(int k=0; k<candidates.size(); ++k){
+                    alive[k] = k;
+                }
+                for(int round=0; round<n_rounds && alive.size()>1; ++round){
+                    int n_games = max(1L, budget/(n_rounds*static_cast<long>(alive.size())));
+                    for(int k : alive){
+                        victories[k] += random_games(board, candidates[k], n_games, shufflable, aux_position,\
+                        this_is_movement_number);
+                        games[k] += n_games;
+                        ratios[k] = static_cast<double>(victories[k])/games[k];
+                    }
+                    stable_sort(alive.begin(), alive.end(), [&](int a, int b){
+                        return ratios[a]+bias[candidates[a]]>ratios[b]+bias[candidates[b]];
+                    });
+                    alive.resize((alive.size()+1)/2);
+                }
+                halving_survivor = candidates[alive[0]]; // (The rounds leave a single candidate)
+                return ratios;
+            }
+
+            pair<int, double> best_candidate(const vector<pair<int, double>>& nodes_and_ratios,\
+            const vector<double>& bias=vector<double>()){ // The move to play among the candidates returned by the last
+            // monte_carlo_ratios() call, and its ratio: the survivor of sequential halving, or else the best ratio
+            // plus bias (if given). (-1, -1) if there are no candidates
+                pair<int, double> best(-1, -1);
+                double best_score = -1;
+                for(auto& candidate : nodes_and_ratios){
+                    if(candidate.first==halving_survivor){
+                        return candidate;
+                    }
+                    double score = candidate.second+(bias.empty()?0:bias[candidate.first]);
+                    if(score>best_score){
+                        best = candidate;
+                        best_score = score;
+                    }
+                }
+                return best;
+            }
+
+            int random_games(const Position& board, int fixed_possible_node, int n_games, vector<int>& shufflable,\
+            Position& aux_position, int this_is_movement_number){
+                // Plays n_games random games after the bot's move on fixed_possible_node, and returns how many of
+                // them the bot wins. (shufflable and aux_position are just reused buffers)
+                int bot_victories = 0;
+                for(int it = 0; it<n_games; ++it){
+                    int aux_current_player = 2; // (initialize to 2, it's the robot's move)
+                    aux_position = board; // (Same size, so the stones are copied without allocating)
+                    aux_position.set_node_tag(fixed_possible_node, aux_current_player); // Mark the fixed move on the auxiliary board
+                    order_for_playout(shufflable, aux_position, 1); // Random order (uniform, or biased by the patterns)
+                    
+                    int aux_this_is_movement_number = this_is_movement_number;
+                    if(swap_rule){ // Possibility of swap
+                        int aux_index = 0;
+                        int nodes_examined = 0;
+                        int aux_current_node = fixed_possible_node;
+                        while(nodes_examined<shufflable.size()){
+                            if(aux_this_is_movement_number==2 && aux_current_player==1 &&\
+                            uniform_real_distribution<double>(0.0, 1.0)(random_generator)<0.5){ // Player 1 randomly chooses whether to do swap or not
+                                aux_position.set_node_tag(fixed_possible_node, aux_current_player);
+                                aux_current_player = (aux_current_player%2)+1;
+                            }else{
+                                aux_position.set_node_tag(aux_current_node, aux_current_player);
+                                aux_current_player = (aux_current_player%2)+1;
+                                ++nodes_examined;
+                                if(shufflable[aux_index] != fixed_possible_node){
+                                    aux_current_node = shufflable[aux_index];
+                                    ++aux_index;
+                                }else{
+                                    if(aux_index+1<shufflable.size()){
+                                        aux_current_node = shufflable[aux_index+1];
+                                        aux_index+=2;
+                                    }
+                                }
+                            }
+                            ++aux_this_is_movement_number;
+                        }
+                    }
+                    // Check who won this Monte Carlo iteration. With no swap permitted, the random game is
+                    // played by the engine of this board size, on bitboards or stopping when it's decided:
+                    bool bot_won;
+                    if(swap_rule){
+                        bot_won = check_bot_won(aux_position);
+                    }else if(use_early_cutoff){
+                        Playout playout = Engine_Dispatcher::random_game(board, fixed_possible_node, shufflable);
+                        bot_won = (playout.winner==2);
+                        ++n_cut_playouts;
+                        n_playout_moves += playout.n_moves;
+                    }else{
+                        bot_won = Engine_Dispatcher::bot_wins_random_game(board, fixed_possible_node, shufflable);
+                    }
+                    if(bot_won){ // Player 2 (bot) wins
+                        ++bot_victories;
+                    }
+                }
+                return bot_victories;
+            }
+
+            bool is_rotation_symmetric(const Position& board){ // True if the stones are the same after rotating
+            // the board 180 degrees (see Position_Hasher)
+                for(int i=0; i<board.V(); ++i){
+                    if(board.get_node_tag(i)!=board.get_node_tag(board.V()-1-i)){
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            Bot_Move choose_move(const Game_State& state){ // (Player 2 to move. See the next one)
+                int movement = state.get_moves().size()+1;
+                int player1_first_move = (movement==2)?state.get_moves()[0].node:-1;
+                return choose_move(state.get_position(), state.get_empty_cells(), movement, player1_first_move);
+            }
+
+            Bot_Move choose_move(const Position& board, const vector<int>& unused_nodes, int this_is_movement_number,\
+            int player1_first_move=-1){
+                // The bot's decision for a move of player 2: the best candidate of the Monte Carlo ratios (see
+                // best_candidate()), with the pattern prior as a small bias which fades with the number of
+                // simulations. At move 2 with swap rule (player1_first_move>=0), the swap map tells whether to
+                // capture player 1's first move, for the board sizes it covers, without any simulation. For
+                // the other sizes, the swap is played if its ratio of victories is higher than the best move's.
+                Bot_Move move;
+                int precomputed_swap = -1;
+                if(swap_rule && player1_first_move>=0){
+                    precomputed_swap = Swap_Map::decision(board.get_border_length(), player1_first_move);
+                    if(precomputed_swap==1){
+                        move.node = player1_first_move;
+                        move.is_swap = true;
+                        return move;
+                    }
+                }
+                move.nodes_and_ratios = monte_carlo_ratios(board, unused_nodes, this_is_movement_number);
+                pair<int, double> best = best_candidate(move.nodes_and_ratios, prior_bias(board));
+                move.node = best.first;
+                move.ratio = best.second;
+                if(swap_rule && player1_first_move>=0 && precomputed_swap<0){
+                    double ratio_with_swap = monte_carlo_ratio_with_swap(board, unused_nodes, player1_first_move);
+                    if(ratio_with_swap>move.ratio){
+                        move.node = player1_first_move;
+                        move.is_swap = true;
+                        move.ratio = ratio_with_swap;
+                    }
+                }
+                return move;
+            }
+
+            double monte_carlo_ratio_with_swap(const Game_State& state, int player1_first_move){
+                return monte_carlo_ratio_with_swap(state.get_position(), state.get_empty_cells(), player1_first_move);
+            }
+
+            double monte_carlo_ratio_with_swap(const Position& board, int player1_first_move){
+                return monte_carlo_ratio_with_swap(board, get_unused_nodes(board), player1_first_move);
+            }
+
+            double monte_carlo_ratio_with_swap(const Position& board, const vector<int>& unused_nodes, int player1_first_move){
+                // Ratio of bot victories if the bot (player 2) uses the swap rule on player 1's first move
+                vector<int> shufflable = unused_nodes;
+                Position aux_position(board);
+                int bot_victories = 0;
+                int human_victories = 0;
+                for(int it = 0; it<n_iterations; ++it){
+                    int aux_current_player = 2; // (initialize to 2, it's the robot's move)
+                    aux_position = board;
+                    aux_position.set_node_tag(player1_first_move, aux_current_player); // Undoing the Player 1's first move and marking
+                    // it as Player 2's !
+                    aux_current_player = (aux_current_player%2)+1; // After the swap, return the turn to the Player 1
+                    order_for_playout(shufflable, aux_position, 1); // Random order (uniform, or biased by the patterns)
+                    for(auto next_node : shufflable){
+                        if(next_node != player1_first_move){
+                            aux_position.set_node_tag(next_node, aux_current_player);
+                            aux_current_player = (aux_current_player%2)+1;
+                        }
+                    }
+                    // Check who won this Monte Carlo iteration:
+                    if(check_bot_won(aux_position)){ // Player 2 (bot) wins
+                        ++bot_victories;
+                    }else{ // DON'T CHECK THE CONNECTION AGAIN, BECAUSE IF PLAYER 2 HAS LOST, PLAYER 1 HAS WON!
+                        ++human_victories;
+                    }
+                }
+                return static_cast<double>(bot_victories)/(bot_victories+human_victories);
+            }
+
+            bool get_swap_rule() const{
+                return swap_rule;
+            }
+
+            int get_n_iterations() const{
+                return n_iterations;
+            }
+
+            long get_n_games(int node) const{ // Random games played on node in the last monte_carlo_ratios() call.
+            // (n_iterations for every candidate, except with sequential halving)
+                return (node>=0 && node<static_cast<int>(candidate_games.size()))?candidate_games[node]:0;
+            }
+
+            void set_sequential_halving(bool enabled){ // (See sequential_halving())
+                use_sequential_halving = enabled;
+                return;
+            }
+
+            bool get_sequential_halving() const{
+                return use_sequential_halving;
+            }
+
+            void set_early_cutoff(bool enabled){ // (See Engine::random_game)
+                use_early_cutoff = enabled;
+                return;
+            }
+
+            bool get_early_cutoff() const{
+                return use_early_cutoff;
+            }
+
+            long get_n_cut_playouts() const{ // Random games played with early cutoff
+                return n_cut_playouts;
+            }
+
+            long get_n_playout_moves() const{ // Moves of those random games until a player connected
+                return n_playout_moves;
+            }
+
+        private:
+            bool swap_rule;
+            int n_iterations; // How many simulations for each possible movement
+            const Pattern_Policy* policy; // Pattern policy for the random games (nullptr for uniform games)
+            mt19937 random_generator; // (Seeded from the global generator)
+            bool use_sequential_halving; // If true, the random games are shared out between the candidates by
+            // sequential halving instead of n_iterations for each one
+            bool use_early_cutoff; // If true, the random games without swap stop as soon as they're decided
+            long n_cut_playouts;
+            long n_playout_moves;
+            int halving_survivor; // Move kept by sequential halving in the last monte_carlo_ratios() call (or -1)
+            vector<long> candidate_games; // Random games of each node in the last monte_carlo_ratios() call
+            Pattern_Codes playout_codes; // Buffers of order_for_playout(), reused by every random game
+            vector<int64_t> playout_weights[2];
+            Weight_Tree playout_trees[2];
+            vector<int> playout_occupied;
+    };
+
+    // ===============================================================================================
+    // class Opening_Book
+    // ===============================================================================================
+    // The opening book is a binary file which is read through mmap, so that nothing has to be parsed
+    // at startup: the file is a header followed by a table of entries sorted by the canonical hash of
+    // the positions, and a lookup is a binary search over the mapped table.
+    struct Book_Header{
+        char magic[8]; // "HEXBOOK2"
+        int32_t border_length;
+        int32_t swap_rule; // 1 if the book was generated for games with the swap rule
+        uint64_t n_entries;
+    };
+
+    struct Book_Entry{
+        uint64_t hash; // Canonical hash of the position, with player 2 (the bot) to move
+        int32_t best_move; // Best move, in the orientation of the canonical image of the position
+        int32_t visits; // Number of Monte Carlo games that were played on best_move
+        float win_ratio; // Ratio of bot victories for best_move
+        int32_t n_candidates; // Number of moves that were evaluated in that position
+    };
+
+    class Opening_Book{
+        public:
+            Opening_Book():entries(nullptr),n_entries(0),border_length(0),swap_rule(false),\
+            mapped(nullptr),mapped_size(0){}
+
+            ~Opening_Book(){close();}
+
+            Opening_Book(const Opening_Book&) = delete; // The mapping can't be shared between two objects
+            Opening_Book& operator=(const Opening_Book&) = delete;
+
+            static string default_filename(int border_length){
+                return "hex_opening_book_"+to_string(border_length)+"x"+to_string(border_length)+".bin";
+            }
+
+            bool open(string filename){ // Maps the book file into memory. Returns false if it can't be used
+                close();
+                int fd = ::open(filename.c_str(), O_RDONLY);
+                if(fd<0){
+                    return false;
+                }
+                struct stat file_info;
+                if(fstat(fd, &file_info)!=0 || file_info.st_size<static_cast<off_t>(sizeof(Book_Header))){
+                    ::close(fd);
+                    return false;
+                }
+                mapped_size = file_info.st_size;
+                void* address = mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd); // The mapping stays valid after closing the descriptor
+                if(address==MAP_FAILED){
+                    mapped_size = 0;
+                    return false;
+                }
+                mapped = static_cast<const char*>(address);
+                const Book_Header* header = reinterpret_cast<const Book_Header*>(mapped);
+                if(string(header->magic, 8)!="HEXBOOK2" ||\
+                mapped_size<sizeof(Book_Header)+header->n_entries*sizeof(Book_Entry)){
+                    cout<<"File "<<filename<<" isn't a valid opening book. Ignoring it."<<endl;
+                    close();
+                    return false;
+                }
+                border_length = header->border_length;
+                swap_rule = (header->swap_rule==1);
+                n_entries = header->n_entries;
+                entries = reinterpret_cast<const Book_Entry*>(mapped+sizeof(Book_Header));
+                hasher = Position_Hasher(border_length);
+                return true;
+            }
+
+            void close(){
+                if(mapped!=nullptr){
+                    munmap(const_cast<char*>(mapped), mapped_size);
+                }
+                mapped = nullptr;
+                mapped_size = 0;
+                entries = nullptr;
+                n_entries = 0;
+                return;
+            }
+
+            bool is_open() const{
+                return mapped!=nullptr;
+            }
+
+            int lookup(const Hex_Board& board, int player_to_move, Book_Entry* found=nullptr) const{
+                // Returns the book move for the position (as a node of "board"), or -1 if the position
+                // isn't in the book
+                if(!is_open() || board.get_border_length()!=border_length){
+                    return -1;
+                }
+                Symmetric_Hashes hashes = hasher.hash(board);
+                int symmetry = hasher.canonical_symmetry(hashes, player_to_move);
+                uint64_t key = hasher.image_hash(hashes, player_to_move, symmetry);
+                const Book_Entry* last = entries+n_entries;
+                const Book_Entry* entry = lower_bound(entries, last, key, [](const Book_Entry& e, uint64_t k){
+                    return e.hash<k;
+                });
+                if(entry==last || entry->hash!=key){
+                    return -1;
+                }
+                int move = hasher.transform_node(entry->best_move, symmetry);
+                if(move<0 || move>=board.V() || board.get_node_tag(move)!=0){ // (Protection against hash collisions)
+                    return -1;
+                }
+                if(found!=nullptr){
+                    *found = *entry;
+                }
+                return move;
+            }
+
+            static bool write(string filename, int border_length, bool swap_rule, vector<Book_Entry> book_entries){
+                // Writes a book file. The entries are sorted here
+                sort(book_entries.begin(), book_entries.end(), [](const Book_Entry& a, const Book_Entry& b){
+                    return a.hash<b.hash;
+                });
+                ofstream file(filename, ios::binary);
+                if(!file){
+                    cout<<"Opening book couldn't be written to "<<filename<<endl;
+                    return false;
+                }
+                Book_Header header;
+                memcpy(header.magic, "HEXBOOK2", 8);
+                header.border_length = border_length;
+                header.swap_rule = swap_rule?1:0;
+                header.n_entries = book_entries.size();
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(book_entries.data()), book_entries.size()*sizeof(Book_Entry));
+                return true;
+            }
+
+            int size() const{
+                return n_entries;
+            }
+
+            int get_border_length() const{
+                return border_length;
+            }
+
+            bool get_swap_rule() const{
+                return swap_rule;
+            }
+
+        private:
+            const Book_Entry* entries; // Table of entries (it points into the mapped file)
+            uint64_t n_entries;
+            int border_length;
+            bool swap_rule;
+            Position_Hasher hasher;
+            const char* mapped; // Address and size of the mapping
+            size_t mapped_size;
+    };
+
+    // ===============================================================================================
+    // class Opening_Book_Generator
+    // ===============================================================================================
+    class Opening_Book_Generator{
+        // Offline tool which builds an opening book with the Monte Carlo engine. Starting from the empty
+        // board (when the bot moves first) and from every first move of player 1 (when player 1 moves
+        // first), it evaluates the positions where the bot has to move, follows the best move found and
+        // then every possible reply of player 1, until the bot has made "bot_moves" moves.
+        // Symmetric positions share their canonical hash, so each of them is evaluated only once.
+
+        public:
+            Opening_Book_Generator(int border_length, int bot_moves, bool swap_rule, int n_iterations=N_MC_ITERATIONS):\
+            border_length(border_length),bot_moves(bot_moves),swap_rule(swap_rule),bot(swap_rule, n_iterations),\
+            hasher(border_length),n_evaluated(0){}
+
+            bool generate(string filename){
+                Hex_Board board(border_length);
+                // The bot moves first:
+                expand(board, 1, bot_moves);
+                // Player 1 moves first. (With swap rule, the bot's second move is a swap decision, which
+                // isn't stored in the book)
+                if(!swap_rule){
+                    for(int first_move=0; first_move<board.V(); ++first_move){
+                        board.set_node_tag(first_move, 1);
+                        expand(board, 2, bot_moves);
+                        board.set_node_tag(first_move, 0);
+                    }
+                }
+                vector<Book_Entry> book_entries;
+                for(auto& entry : positions){
+                    book_entries.push_back(entry.second);
+                }
+                cout<<"Opening book generated: "<<book_entries.size()<<" positions."<<endl;
+                return Opening_Book::write(filename, border_length, swap_rule, book_entries);
+            }
+
+        private:
+            void expand(Hex_Board& board, int movement_number, int bot_moves_left){ // The bot is to move on "board"
+                if(bot_moves_left==0){
+                    return;
+                }
+                Symmetric_Hashes hashes = hasher.hash(board);
+                int symmetry = hasher.canonical_symmetry(hashes, 2);
+                uint64_t key = hasher.image_hash(hashes, 2, symmetry);
+                if(positions.find(key)==positions.end()){
+                    vector<pair<int, double>> nodes_and_ratios = bot.monte_carlo_ratios(board, movement_number);
+                    pair<int, double> best = bot.best_candidate(nodes_and_ratios);
+                    Book_Entry entry;
+                    entry.hash = key;
+                    entry.best_move = hasher.transform_node(best.first, symmetry);
+                    entry.visits = bot.get_n_games(best.first);
+                    entry.win_ratio = best.second;
+                    entry.n_candidates = nodes_and_ratios.size();
+                    positions[key] = entry;
+                    ++n_evaluated;
+                    cout<<"  Position "<<n_evaluated<<" evaluated (move "<<movement_number<<", ratio "<<best.second<<")"<<endl;
+                }
+                int best_move = hasher.transform_node(positions[key].best_move, symmetry);
+                if(bot_moves_left==1){
+                    return;
+                }
+                // Follow the best move and every reply of player 1:
+                board.set_node_tag(best_move, 2);
+                for(int reply=0; reply<board.V(); ++reply){
+                    if(board.get_node_tag(reply)==0){
+                        board.set_node_tag(reply, 1);
+                        expand(board, movement_number+2, bot_moves_left-1);
+                        board.set_node_tag(reply, 0);
+                    }
+                }
+                if(swap_rule && movement_number==1){ // Player 1 may also swap the bot's first move
+                    board.set_node_tag(best_move, 1);
+                    expand(board, movement_number+2, bot_moves_left-1);
+                }
+                board.set_node_tag(best_move, 0);
+                return;
+            }
+
+        private:
+            int border_length;
+            int bot_moves;
+            bool swap_rule;
+            MonteCarlo_Bot bot;
+            Position_Hasher hasher;
+            unordered_map<uint64_t, Book_Entry> positions;
+            int n_evaluated;
+    };
+
+    // ===============================================================================================
+    // class Swap_Map_Generator
+    // ===============================================================================================
+    class Swap_Map_Generator{
+        // Offline tool which computes the swap map of a board size (see Swap_Map) and prints it as a
+        // line of the table in Swap_Map::map_of_size(). Swapping player 1's first move on node c leaves
+        // a stone of player 2 on c with player 1 to move, so the swap is favourable if that position is
+        // lost for player 1. With "exact", it's decided by Hex_Solver; otherwise, by comparing the
+        // Monte Carlo ratio of the swap with that of the best ordinary move. (The random games are drawn
+        // from "seed", so a Monte Carlo map can be reproduced, but it's only an estimate: see Swap_Map)
+
+        public:
+            Swap_Map_Generator(int border_length, bool exact, int n_iterations=N_MC_ITERATIONS, uint32_t seed=1):\
+            border_length(border_length),exact(exact),bot(true, n_iterations){
+                bot.set_seed(seed);
+            }
+
+            string generate(){
+                Hex_Board board(border_length);
+                Hex_Solver solver(border_length, numeric_limits<long>::max());
+                string cells(border_length*border_length, '.');
+                for(int first_move=0; first_move<board.V(); ++first_move){
+                    int rotated = board.V()-1-first_move;
+                    if(rotated<first_move){ // Same decision as its rotated node
+                        cells[first_move] = cells[rotated];
+                        continue;
+                    }
+                    bool favourable;
+                    if(exact){
+                        board.set_node_tag(first_move, 2);
+                        favourable = (solver.solve(board, 1)==SOLVER_LOSS);
+                        board.set_node_tag(first_move, 0);
+                    }else{
+                        board.set_node_tag(first_move, 1);
+                        double best_ratio = bot.best_candidate(bot.monte_carlo_ratios(board, 2)).second;
+                        favourable = (bot.monte_carlo_ratio_with_swap(board, first_move)>best_ratio);
+                        board.set_node_tag(first_move, 0);
+                    }
+                    cells[first_move] = favourable?'S':'.';
+                    cout<<"  First move on node "<<first_move<<": "<<(favourable?"swap":"don't swap")<<endl;
+                }
+                return "{"+to_string(border_length)+", \""+cells+"\"}";
+            }
+
+        private:
+            int border_length;
+            bool exact;
+            MonteCarlo_Bot bot;
+    };
+
+    // ===============================================================================================
+    // class Pattern_Trainer
+    // ===============================================================================================
+    class Pattern_Trainer{
+        // Offline tool which learns the weights of Pattern_Policy from self-play games of the Monte
+        // Carlo engine. The engine only plays as player 2, so player 1's moves are computed on the
+        // transposed and colour swapped board and mapped back. Every move is recorded from the point
+        // of view of player 1 (player 2's moves, on the transposed board), counting how many times each
+        // pattern was chosen and how many times it would have been chosen by a uniform random move: a
+        // move with E empty cells chooses each of them with probability 1/E, so every available pattern
+        // adds 1/E to its "expected" count. The weight of a pattern is how much more (or less) often it
+        // was chosen than by chance, smoothed with one pseudo-count so that rare patterns stay close to 1:
+        //      weight = (chosen+1)/(expected+1)
+
+        public:
+            Pattern_Trainer(int border_length, int n_games, int n_iterations=N_MC_ITERATIONS):\
+            border_length(border_length),n_games(n_games),bot(false, n_iterations){}
+
+            bool train(string filename){
+                vector<double> expected(Pattern_Policy::N_PATTERNS, 0); // Choices of each pattern by uniform random moves
+                vector<double> chosen(Pattern_Policy::N_PATTERNS, 0);
+                for(int game=0; game<n_games; ++game){
+                    Hex_Board board(border_length);
+                    Hex_Board image(border_length); // Transposed and colour swapped copy of board
+                    int player = (game%2)+1; // Both players start in half of the games
+                    for(int movement=1; movement<=board.V(); ++movement){
+                        Hex_Board& engine_board = (player==2)?board:image; // Where the mover is player 2
+                        Hex_Board& record_board = (player==1)?board:image; // Where the mover is player 1
+                        pair<int,double> best = bot.best_candidate(bot.monte_carlo_ratios(engine_board, movement));
+                        int move = (player==2)?best.first:transpose(best.first);
+                        int record_move = (player==1)?move:transpose(move);
+                        Pattern_Codes codes(record_board);
+                        double n_empty = record_board.V()-(movement-1);
+                        for(int node=0; node<record_board.V(); ++node){
+                            if(record_board.get_node_tag(node)==0){
+                                expected[codes.code(node)] += 1/n_empty;
+                            }
+                        }
+                        chosen[codes.code(record_move)] += 1;
 
-                // Now mark those nodes which are banned
-                vector<int> banned_nodes;
-                for(int i=0; i<graph.V(); ++i){
-                    int tag_read = graph.get_node_tag(i);
-                    for(int banned_tag : avoid_nodes_with_these_tags){
-                        if(tag_read==banned_tag){
-                            banned_nodes.push_back(i);
+                        board.set_node_tag(move, player);
+                        image.set_node_tag(transpose(move), 3-player);
+                        if((player==2 && bot.check_bot_won(board)) || (player==1 && bot.check_bot_won(image))){
+                            cout<<"  Game "<<game+1<<" of "<<n_games<<": player "<<player<<" wins in "<<movement<<\
+                            " movements"<<endl;
                             break;
                         }
+                        player = 3-player;
                     }
                 }
-                // If nodeFrom or nodeTo are in banned_nodes, no path can be computed. Return:
-                for(int node : banned_nodes){
-                    if(node==nodeFrom || node==nodeTo){
-                        // cout<<"\nNo path can be computed because the source node or the destination node are prohibited nodes!"<<endl;
-                        terminated = true;
-                        path_was_seeked = true;
-                        path_exists = false;
-                        return;
+                vector<float> weights(Pattern_Policy::N_PATTERNS);
+                for(int code=0; code<Pattern_Policy::N_PATTERNS; ++code){
+                    weights[code] = (chosen[code]+1)/(expected[code]+1);
+                }
+                Pattern_Policy policy;
+                policy.set_weights(weights);
+                return policy.save(filename);
+            }
+
+        private:
+            int transpose(int node){
+                return (node%border_length)*border_length+(node/border_length);
+            }
+
+            int border_length;
+            int n_games;
+            MonteCarlo_Bot bot;
+    };
+
+    // ===============================================================================================
+    // class Game_Log
+    // ===============================================================================================
+    // Games are saved in an append-only binary log: the characters "HEXGAME1" and then one record per
+    // game, each one prefixed by its length in bytes (uint32), so that a reader can skip the fields it
+    // doesn't know and a record which was cut off (by a crash while writing) is simply ignored.
+    // The fields of a record are, in order:
+    //      border_length (uint8), swap_rule (uint8), first_player (uint8), winner (uint8, 0 if unfinished),
+    //      n_iterations (uint32, Monte Carlo games per move of player 2's bot, 0 if player 2 wasn't a bot),
+    //      bot_time_ms (uint32, time spent by player 2's bot), n_moves (uint32),
+    //      moves (n_moves x uint16, the node of each move, or 0xFFFF for a swap),
+    //      player1_n_iterations and player1_bot_time_ms (uint32 each, the same for player 1, as in the
+    //      self-play tournaments. Older records end before them, so they're read as 0).
+    // Records are written and read one at a time, so millions of games can be streamed with bounded memory.
+    struct Game_Record{
+        static constexpr int SWAP_MOVE = -1; // In moves, a swap (it always takes over the first move)
+
+        int border_length = 0;
+        bool swap_rule = false;
+        int first_player = 1;
+        int winner = 0;
+        uint32_t n_iterations = 0; // (Player 2's bot)
+        uint32_t bot_time_ms = 0;
+        vector<int> moves;
+        uint32_t player1_n_iterations = 0; // (Player 1's bot)
+        uint32_t player1_bot_time_ms = 0;
+
+        static Game_Record from_state(const Game_State& state, bool swap_rule){ // The moves of a game (the rest of
+        // the fields are left to the caller)
+            Game_Record record;
+            record.border_length = state.get_position().get_border_length();
+            record.swap_rule = swap_rule;
+            const vector<Game_State::Move>& moves = state.get_moves();
+            record.first_player = (moves.size()>0)?moves[0].player:state.get_position().get_side_to_move();
+            for(const Game_State::Move& move : moves){
+                record.moves.push_back(move.is_swap?SWAP_MOVE:move.node);
+            }
+            return record;
+        }
+
+        bool is_valid() const{ // True if the record describes a legal game that to_state() can replay: a board
+        // of 1 to 255 cells per side, players and winner in range, every move on an empty cell of the board,
+        // and the swap only as the second move
+            if(border_length<1 || border_length>255 || (first_player!=1 && first_player!=2) || winner<0 || winner>2){
+                return false;
+            }
+            int V = border_length*border_length;
+            vector<bool> occupied(V, false);
+            for(size_t k=0; k<moves.size(); ++k){
+                if(moves[k]==SWAP_MOVE){
+                    if(k!=1){
+                        return false;
                     }
+                }else if(moves[k]<0 || moves[k]>=V || occupied[moves[k]]){
+                    return false;
+                }else{
+                    occupied[moves[k]] = true;
                 }
-                
-                // Begin computation:
+            }
+            return true;
+        }
 
-                // Label all of the not banned nodes, except for nodeFrom, as unvisited:
-                for(int i=0; i<graph.V(); ++i){
-                    if(!i_is_in_vector(i,banned_nodes)){
-                        if(i!=nodeFrom){
-                            open_set.push_back(i);
-                        }else{
-                            closed_set.push_back(i);
-                        }
+        Game_State to_state() const{ // Replays the moves (of a valid record, see is_valid())
+            Game_State state(border_length, first_player);
+            for(int move : moves){
+                if(move==SWAP_MOVE){
+                    state.swap(state.get_moves()[0].node);
+                }else{
+                    state.play(move);
+                }
+            }
+            return state;
+        }
+    };
+
+    class Game_Log_Writer{
+        public:
+            Game_Log_Writer():n_written(0){}
+
+            static string default_filename(){
+                return "hex_games.bin";
+            }
+
+            bool open(string filename){ // Opens the log to append games (it's created if it doesn't exist)
+                close();
+                file.open(filename, ios::binary|ios::app);
+                if(!file){
+                    cout<<"Game log "<<filename<<" couldn't be opened."<<endl;
+                    return false;
+                }
+                file.seekp(0, ios::end);
+                if(file.tellp()==0){
+                    file.write("HEXGAME1", 8);
+                }
+                return true;
+            }
+
+            bool write(const Game_Record& record){
+                if(!file.is_open()){
+                    return false;
+                }
+                buffer.clear();
+                put<uint8_t>(record.border_length);
+                put<uint8_t>(record.swap_rule?1:0);
+                put<uint8_t>(record.first_player);
+                put<uint8_t>(record.winner);
+                put<uint32_t>(record.n_iterations);
+                put<uint32_t>(record.bot_time_ms);
+                put<uint32_t>(record.moves.size());
+                for(int move : record.moves){
+                    put<uint16_t>((move==Game_Record::SWAP_MOVE)?0xFFFF:move);
+                }
+                put<uint32_t>(record.player1_n_iterations);
+                put<uint32_t>(record.player1_bot_time_ms);
+                uint32_t length = buffer.size();
+                file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                file.write(buffer.data(), buffer.size());
+                ++n_written;
+                return static_cast<bool>(file);
+            }
+
+            void flush(){
+                file.flush();
+                return;
+            }
+
+            void close(){
+                if(file.is_open()){
+                    file.close();
+                }
+                return;
+            }
+
+            long get_n_written() const{
+                return n_written;
+            }
+
+        private:
+            template<typename fieldType>
+            void put(fieldType value){
+                const char* bytes = reinterpret_cast<const char*>(&value);
+                buffer.insert(buffer.end(), bytes, bytes+sizeof(value));
+                return;
+            }
+
+            ofstream file;
+            vector<char> buffer; // The record being written (reused, so that writing doesn't allocate)
+            long n_written;
+    };
+
+    class Game_Log_Reader{
+        public:
+            bool open(string filename){
+                file.close();
+                file.clear();
+                file.open(filename, ios::binary);
+                if(!file){
+                    return false;
+                }
+                char magic[8];
+                file.read(magic, 8);
+                if(!file || string(magic, 8)!="HEXGAME1"){
+                    cout<<"File "<<filename<<" isn't a game log. Ignoring it."<<endl;
+                    file.close();
+                    return false;
+                }
+                return true;
+            }
+
+            bool next(Game_Record& record){ // Reads the next game. False at the end of the log
+            // (Records which aren't valid games are skipped, see read_record())
+                while(true){
+                    uint32_t length = 0;
+                    if(!file.is_open() || !file.read(reinterpret_cast<char*>(&length), sizeof(length))){
+                        return false;
+                    }
+                    if(length>MAX_RECORD_LENGTH){
+                        cout<<"Corrupted record in the game log. Stopping there."<<endl;
+                        file.close();
+                        return false;
+                    }
+                    buffer.resize(length);
+                    if(!file.read(buffer.data(), length)){
+                        return false; // (A record cut off at the end of the file)
                     }
+                    if(read_record(record)){
+                        return true;
+                    }
+                    cout<<"Invalid record in the game log. Skipping it."<<endl;
                 }
+            }
 
-                // Set tentative costs to infinity, except for the nodeFrom's which is zero:
-                for(int i=0; i<graph.V(); ++i){
-                    if(i!=nodeFrom){
-                        tentative_costs.push_back(numeric_limits<numType>::infinity()>numeric_limits<numType>::max()?numeric_limits<numType>::infinity():numeric_limits<numType>::max());
+        private:
+            static constexpr uint32_t HEADER_LENGTH = 16; // (The fields before the moves)
+
+            bool read_record(Game_Record& record){ // Decodes the record in buffer. False if its length doesn't
+            // match its number of moves or it isn't a valid game (see Game_Record::is_valid())
+                position = 0;
+                record.border_length = get<uint8_t>();
+                record.swap_rule = (get<uint8_t>()==1);
+                record.first_player = get<uint8_t>();
+                record.winner = get<uint8_t>();
+                record.n_iterations = get<uint32_t>();
+                record.bot_time_ms = get<uint32_t>();
+                uint32_t n_moves = get<uint32_t>();
+                size_t moves_end = HEADER_LENGTH+2*static_cast<size_t>(n_moves);
+                if(buffer.size()!=moves_end && buffer.size()!=moves_end+8){ // (Older records end with the moves)
+                    return false;
+                }
+                record.moves.clear();
+                for(uint32_t k=0; k<n_moves; ++k){
+                    uint16_t move = get<uint16_t>();
+                    record.moves.push_back((move==0xFFFF)?Game_Record::SWAP_MOVE:move);
+                }
+                record.player1_n_iterations = get<uint32_t>();
+                record.player1_bot_time_ms = get<uint32_t>();
+                return record.is_valid();
+            }
+
+            static constexpr uint32_t MAX_RECORD_LENGTH = HEADER_LENGTH+2*(255*255+1)+8; // The fields of a record with the
+            // moves of a full 255x255 board plus the swap (the border length is written on 8 bits)
+
+            template<typename fieldType>
+            fieldType get(){ // The next field of the record (0 if the record is shorter)
+                fieldType value = 0;
+                if(position+sizeof(value)<=buffer.size()){
+                    memcpy(&value, buffer.data()+position, sizeof(value));
+                }
+                position += sizeof(value);
+                return value;
+            }
+
+            ifstream file;
+            vector<char> buffer;
+            size_t position = 0;
+    };
+
+    // ===============================================================================================
+    // class SGF_Exporter
+    // ===============================================================================================
+    class SGF_Exporter{
+        // Writes games in the SGF format of Hex (GM[11], as read by HexGUI and other Hex programs). Player 1
+        // ("X", North-South) is Black and player 2 ("O", West-East) is White. A cell is written as its
+        // column letter and its row number, so (x,y) = (0,0) is a1. The swap is written as a setup node
+        // that turns the first stone into the swapper's colour on the same cell (AB[]/AW[] and PL[]), as the
+        // swap of this game doesn't mirror the stone ("swap-pieces" does in HexGUI).
+
+        public:
+            static string to_sgf(const Game_Record& record){
+                ostringstream sgf;
+                sgf<<"(;FF[4]GM[11]AP[HexGame_with_AI_bot]SZ["<<record.border_length<<"]";
+                if(record.winner!=0){
+                    sgf<<"RE["<<((record.winner==1)?"B":"W")<<"+]";
+                }
+                string bots;
+                if(record.player1_n_iterations>0){
+                    bots = "Black: "+bot_comment(record.player1_n_iterations, record.player1_bot_time_ms);
+                }
+                if(record.n_iterations>0){
+                    bots += (bots.empty()?"":"; White: ")+bot_comment(record.n_iterations, record.bot_time_ms);
+                }
+                if(!bots.empty()){
+                    sgf<<"GC["<<bots<<"]";
+                }
+                int player = record.first_player;
+                for(int move : record.moves){
+                    string colour = (player==1)?"B":"W";
+                    if(move==Game_Record::SWAP_MOVE && !record.moves.empty()){
+                        sgf<<";A"<<colour<<"["<<cell_name(record.moves[0], record.border_length)<<"]";
+                        sgf<<"PL["<<((player==1)?"W":"B")<<"]";
                     }else{
-                        tentative_costs.push_back(0);
+                        sgf<<";"<<colour<<"["<<cell_name(move, record.border_length)<<"]";
                     }
+                    player = (player%2)+1;
                 }
+                sgf<<")";
+                return sgf.str();
+            }
 
-                // Begin iterating.
-                terminated = false;
-                currentNode = nodeFrom;
-                while(terminated == false){
-                    // Locate the current node's neighbors:
-                    neighbors = graph.neighbors(currentNode);
-                    // Add to the priority queue (this is done in increasing order) those neighbours
-                    // of currentNode which are in the open set:
-                    for(int i=0; i<neighbors.size(); ++i){
-                        if(find(open_set.begin(), open_set.end(), neighbors[i].get_value1()) != open_set.end() &&\
-                        !i_is_in_vector(neighbors[i].get_value1(),banned_nodes)){ // This means
-                            // if(neighbors[i].node_number is in open_set and neighbors[i].node_number is not banned)
-                            // But before adding those neighbors to the queue, their costs must be updated
-                            // to the current total value, by adding the cost of the currentNode up to now !
-                            int_and_num_Pair<numType> temp = neighbors[i];
-                            temp.set_value2(temp.get_value2() + tentative_costs[currentNode]);
-                            int_int_and_num_Triad<numType> triad = join_current_and_neighbor_and_cost(currentNode, temp);
-                            // Important: We must add the element to the queue if it improves the total cost towards
-                            // a new node. If that node is already with less or equal cost in the queue, don't add it.
-                            // But if it was in the queue with more cost, add the new one and delete the old one (update the queue)
-                            if(queue.contains_elem_with_val1_val2(triad.get_value1(), triad.get_value2())==false\
-                            && queue.improves_cost_of_node(triad)){
-                                queue.update_queue_with_shorter_path(triad);
-                            }
+            static string bot_comment(uint32_t n_iterations, uint32_t bot_time_ms){
+                return "Monte Carlo bot, "+to_string(n_iterations)+" games per move, "+to_string(bot_time_ms)+" ms";
+            }
+
+            static string cell_name(int node, int border_length){ // Column letter (a, b, ...) and row number (1, 2, ...)
+                string name;
+                int column = node%border_length;
+                do{ // (Columns after z are aa, ab...)
+                    name.insert(name.begin(), static_cast<char>('a'+column%26));
+                    column = column/26-1;
+                }while(column>=0);
+                return name+to_string(node/border_length+1);
+            }
+
+            static int cell_node(string name, int border_length){ // Inverse of cell_name(). -1 if it isn't a cell
+                size_t k = 0;
+                int column = 0;
+                for(; k<name.size() && name[k]>='a' && name[k]<='z'; ++k){
+                    column = column*26+(name[k]-'a'+1);
+                }
+                int row = (k>0 && k<name.size())?atoi(name.c_str()+k):0;
+                if(row<1 || row>border_length || column<1 || column>border_length){
+                    return -1;
+                }
+                return (row-1)*border_length+column-1;
+            }
+
+            static bool from_sgf(const string& sgf, Game_Record& record){ // Reads back a game written by to_sgf()
+            // (the size, the result and the moves). False if it isn't such a game
+                record = Game_Record();
+                size_t k = 0;
+                while(k<sgf.size()){
+                    if(!isupper(static_cast<unsigned char>(sgf[k]))){
+                        ++k;
+                        continue;
+                    }
+                    string property;
+                    for(; k<sgf.size() && isupper(static_cast<unsigned char>(sgf[k])); ++k){
+                        property += sgf[k];
+                    }
+                    vector<string> values;
+                    while(k<sgf.size() && sgf[k]=='['){
+                        size_t end = sgf.find(']', k);
+                        if(end==string::npos){
+                            return false;
                         }
+                        values.push_back(sgf.substr(k+1, end-k-1));
+                        k = end+1;
                     }
-                    // What happens if the currentNode doesn't have neigbors, nor has neighbors which are in the
-                    // open set, nor has neighbours which are in the open set and improve the cost?
-                    // --> Just nothing is added to the queue in this iteration
-
-                    // Now we choose the "To" node in the priority queue which has the least cost. That is
-                    // the top of the queue. We mark that node as current node for the next iteration.
-                    // we remove that element from the queue and we move that node from the open set to the
-                    // closed set. We also update the cost of that node up to now, by updating the value stored
-                    // in tentative_costs whit that one which the top of the queue contained.
-                    // Additionally, evaluate the terminating condition in order to know if the shortest path has been reached!
-                    if(queue.size()>0 && queue.theres_any_in_queue_not_in_ref(used_queue_elements)){
-                        int_int_and_num_Triad<numType> aux_top_of_queue = queue.get_first_in_queue_not_in_ref_NotDelete(used_queue_elements);
-                        if(aux_top_of_queue.get_value2()!=nodeTo){
-                            // We must not move the nodeTo
-                            // to the closed_set even if we are to reach it in this iteration, because
-                            // even having visited it, there may be other shorter paths that have to
-                            // be tested and exhausted.
-                            // Furthermore, if the upcoming node is nodeTo, the special code of the
-                            // else{} must be used, not this block.
-                            int_int_and_num_Triad<numType> another_aux_element = queue.getAndDelete_first_in_queue_not_in_ref(used_queue_elements);
-                            used_queue_elements.push_back(another_aux_element);
-                            last_top_of_queue = another_aux_element;
-                            currentNode = last_top_of_queue.get_value2();
-                            for(int i=0; i<open_set.size(); ++i){
-                                if(open_set[i]==currentNode){ 
-                                    open_set.erase(open_set.begin()+i);
-                                    closed_set.push_back(currentNode);
-                                    break;
-                                }
-                            }
-                            tentative_costs[currentNode] = last_top_of_queue.get_value3();
-                        }else{
-                            nodeTo_was_visited = true;
-                            int_int_and_num_Triad<numType> another_aux_element\
-                            = queue.get_first_in_queue_not_in_ref_NotDelete(used_queue_elements); // DON'T use delete, to be able to know afterwards
-                            // that this element of the queue has been used
-                            used_queue_elements.push_back(another_aux_element);
-                            last_top_of_queue = another_aux_element; // DON'T use delete, to be able to know afterwards
-                            // that this element of the queue has been used
-                            tentative_costs[currentNode] = last_top_of_queue.get_value3(); // Updates
-                            // the tentative cost of the nodeTo
-                            // Now, we have to focus on the next element of the queue (if it exists. If not,
-                            // we have terminated) to see which node has to be the currentNode. Set that
-                            // current node and proceed to the next iteration.
-                            if(queue.size()>0 && queue.theres_any_in_queue_not_in_ref(used_queue_elements)){
-                                currentNode = queue.get_first_in_queue_not_in_ref_NotDelete(used_queue_elements).get_value1();
-                                // Now, for the next iteration we have to avoid to enter on a loop, so we mustn't
-                                // add to the priority queue the neighbours that we have already added, and we
-                                // mustn't revisit the paths we have already run.
-                            }else{
-                                terminated = true;
-                                path_exists = true;
-                            }
+                    if(values.empty()){
+                        return false;
+                    }
+                    if(property=="SZ"){
+                        record.border_length = atoi(values[0].c_str());
+                    }else if(property=="RE"){
+                        record.winner = (values[0][0]=='B')?1:(values[0][0]=='W')?2:0;
+                    }else if(property=="B" || property=="W"){
+                        int node = cell_node(values[0], record.border_length);
+                        if(node<0){
+                            return false;
                         }
-                    }else{ // We have exhausted the potential shorter paths and we can't continue.
-                    // If up to this point the nodeTo has been visited, the path exists and the algorithm
-                    // has finished. Otherwise, no path from nodeFrom to nodeTo exists!
-                        terminated = true;
-                        if(nodeTo_was_visited){
-                            path_exists = true;
-                        }else{
-                            path_exists = false;
+                        if(record.moves.empty()){
+                            record.first_player = (property=="B")?1:2;
+                        }
+                        record.moves.push_back(node);
+                    }else if(property=="AB" || property=="AW"){ // (Only the swap is written as a setup node)
+                        if(record.moves.size()!=1 || cell_node(values[0], record.border_length)!=record.moves[0]){
+                            return false;
                         }
+                        record.moves.push_back(Game_Record::SWAP_MOVE);
                     }
                 }
-                path_was_seeked = true;
+                return record.is_valid();
+            }
+
+            static long export_log(string log_filename, string sgf_filename){ // Writes every game of the log as
+            // a game tree of a single SGF collection, one game at a time, and checks that each game read back
+            // from its SGF replays to the same position. Returns the number of games, or -1
+                Game_Log_Reader reader;
+                if(!reader.open(log_filename)){
+                    cout<<"Game log "<<log_filename<<" couldn't be read."<<endl;
+                    return -1;
+                }
+                ofstream sgf(sgf_filename);
+                if(!sgf){
+                    cout<<"SGF file "<<sgf_filename<<" couldn't be written."<<endl;
+                    return -1;
+                }
+                Game_Record record, read_back;
+                long n_games = 0, n_mismatches = 0;
+                while(reader.next(record)){
+                    string text = to_sgf(record);
+                    sgf<<text<<"\n";
+                    ++n_games;
+                    if(!from_sgf(text, read_back) || read_back.moves!=record.moves || read_back.winner!=record.winner ||
+                       read_back.to_state().get_position().to_text()!=record.to_state().get_position().to_text()){
+                        ++n_mismatches;
+                    }
+                }
+                if(n_mismatches>0){
+                    cout<<"Warning: "<<n_mismatches<<" games don't replay the same from their SGF."<<endl;
+                }
+                return n_games;
+            }
+    };
+
+    // ===============================================================================================
+    // class Self_Play_Tournament
+    // ===============================================================================================
+    struct Engine_Settings{ // Settings of one of the engines of a tournament
+        int n_iterations = N_MC_ITERATIONS; // Random games for each candidate move (on average)
+        bool use_patterns = false; // If true, the random games and the prior use the pattern weights
+        bool sequential_halving = false; // If true, the random games are shared out by sequential halving
+        bool early_cutoff = false; // If true, the random games stop as soon as they're decided
+
+        static Engine_Settings parse(string text){ // "<iterations>" and then the letters of the options:
+        // p to use the patterns, h for sequential halving, c for early cutoff (e.g. "750ph")
+            Engine_Settings settings;
+            settings.n_iterations = max(1, atoi(text.c_str()));
+            settings.use_patterns = (text.find('p')!=string::npos);
+            settings.sequential_halving = (text.find('h')!=string::npos);
+            settings.early_cutoff = (text.find('c')!=string::npos);
+            return settings;
+        }
+
+        string name() const{
+            return to_string(n_iterations)+(use_patterns?"p":"")+(sequential_halving?"h":"")+(early_cutoff?"c":"");
+        }
+    };
+
+    class Self_Play_Tournament{
+        // Headless runner of engine-vs-engine games, to check a change of the engine against playing
+        // strength. Engines A and B play n_games games, shared out between n_threads threads. A is player 1
+        // in the even games and B in the odd ones (player 1 always moves first). Each move is chosen by
+        // MonteCarlo_Bot::choose_move(), as the bot does in Hex_Game::game_loop(), but without the opening
+        // book or the exact solver, so that only the engine settings make the difference. The
+        // engine only plays as player 2, so player 1's moves are computed on the transposed and colour
+        // swapped position (see Position::transposed()), as in Pattern_Trainer.
+        // Every game seeds the bots with its own seed, so the results don't depend on the number of threads.
+
+        public:
+            struct Result{
+                int n_games = 0;
+                int wins_a = 0;
+                int first_player_wins = 0; // (Games won by player 1)
+                long n_moves = 0;
+                double seconds = 0;
+                double playout_length_a = -1; // Average length of the random games of each engine (only
+                double playout_length_b = -1; // with early cutoff, -1 otherwise)
+            };
+
+            Self_Play_Tournament(int border_length, bool swap_rule, int n_games, Engine_Settings engine_a,\
+            Engine_Settings engine_b, int n_threads=0):border_length(border_length),swap_rule(swap_rule),\
+            n_games(n_games),engine_a(engine_a),engine_b(engine_b),n_threads(n_threads),game_log(nullptr){
+                if(this->n_threads<=0){
+                    this->n_threads = max(1u, thread::hardware_concurrency());
+                }
+            }
+
+            void set_game_log(Game_Log_Writer* writer){ // The finished games are also appended to this log
+                game_log = writer;
+                return;
+            }
+
+            Result run(){
+                if((engine_a.use_patterns || engine_b.use_patterns) && !policy.load(Pattern_Policy::default_filename())){
+                    cout<<"Pattern weights couldn't be loaded. The engines will play without them."<<endl;
+                }
+                vector<uint32_t> seeds(n_games);
+                for(uint32_t& seed : seeds){
+                    seed = gen();
+                }
+                // The bots are built here, as they are seeded from the global generator:
+                vector<MonteCarlo_Bot> bots_a(n_threads, MonteCarlo_Bot(swap_rule, engine_a.n_iterations));
+                vector<MonteCarlo_Bot> bots_b(n_threads, MonteCarlo_Bot(swap_rule, engine_b.n_iterations));
+                for(int t=0; t<n_threads; ++t){
+                    bots_a[t].set_policy(engine_a.use_patterns?&policy:nullptr);
+                    bots_b[t].set_policy(engine_b.use_patterns?&policy:nullptr);
+                    bots_a[t].set_sequential_halving(engine_a.sequential_halving);
+                    bots_b[t].set_sequential_halving(engine_b.sequential_halving);
+                    bots_a[t].set_early_cutoff(engine_a.early_cutoff);
+                    bots_b[t].set_early_cutoff(engine_b.early_cutoff);
+                }
+
+                vector<int> winners(n_games, 0);
+                vector<int> game_lengths(n_games, 0);
+                atomic<int> next_game(0);
+                mutex output_mutex; // (For the progress lines and the game log)
+                auto worker = [&](int t){
+                    for(int game=next_game++; game<n_games; game=next_game++){
+                        bots_a[t].set_seed(seeds[game]);
+                        bots_b[t].set_seed(seeds[game]^0x9E3779B9u);
+                        array<double, 3> seconds = {0, 0, 0}; // (Time of each player's engine)
+                        Game_State state = play_game(game, bots_a[t], bots_b[t], seconds);
+                        winners[game] = state.get_winner();
+                        game_lengths[game] = state.get_moves().size();
+
+                        lock_guard<mutex> lock(output_mutex);
+                        cout<<"  Game "<<game+1<<" of "<<n_games<<": "<<(a_wins(game, winners[game])?"A":"B")<<\
+                        " wins as player "<<winners[game]<<" in "<<game_lengths[game]<<" movements"<<endl;
+                        if(game_log!=nullptr){
+                            Game_Record record = Game_Record::from_state(state, swap_rule);
+                            record.winner = winners[game];
+                            record.player1_n_iterations = engine(game, 1).n_iterations;
+                            record.player1_bot_time_ms = static_cast<uint32_t>(seconds[1]*1000);
+                            record.n_iterations = engine(game, 2).n_iterations;
+                            record.bot_time_ms = static_cast<uint32_t>(seconds[2]*1000);
+                            game_log->write(record);
+                        }
+                    }
+                };
+                auto start = chrono::steady_clock::now();
+                vector<thread> workers;
+                for(int t=0; t<n_threads; ++t){
+                    workers.push_back(thread(worker, t));
+                }
+                for(thread& aux : workers){
+                    aux.join();
+                }
+
+                Result result;
+                result.seconds = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+                result.n_games = n_games;
+                for(int game=0; game<n_games; ++game){
+                    result.wins_a += a_wins(game, winners[game])?1:0;
+                    result.first_player_wins += (winners[game]==1)?1:0;
+                    result.n_moves += game_lengths[game];
+                }
+                result.playout_length_a = average_playout_length(bots_a);
+                result.playout_length_b = average_playout_length(bots_b);
+                return result;
+            }
 
-                // Now, reproduce the path found (if it exists) and store it
-                if(path_exists==true){
-                    reproduce_found_path();
+            void print(const Result& result) const{
+                double ratio = (result.n_games>0)?static_cast<double>(result.wins_a)/result.n_games:0;
+                pair<double, double> interval = wilson_interval(result.wins_a, result.n_games);
+                cout<<"\nTournament on "<<border_length<<" x "<<border_length<<" boards, swap rule "<<\
+                (swap_rule?"enabled":"not enabled")<<", "<<n_threads<<" threads"<<endl;
+                cout<<"  Engine A: "<<engine_a.name()<<"   Engine B: "<<engine_b.name()<<\
+                "   (iterations, p = patterns, h = sequential halving, c = early cutoff)"<<endl;
+                cout<<"  Games: "<<result.n_games<<"   A wins: "<<result.wins_a<<"   B wins: "<<\
+                result.n_games-result.wins_a<<"   Player 1 wins: "<<result.first_player_wins<<endl;
+                cout<<"  Ratio of victories of A: "<<ratio<<"   95% interval: ["<<interval.first<<", "<<\
+                interval.second<<"]"<<endl;
+                cout<<"  Elo difference A - B: "<<elo_text(ratio)<<"   95% interval: ["<<elo_text(interval.first)<<\
+                ", "<<elo_text(interval.second)<<"]"<<endl;
+                cout<<"  Time: "<<result.seconds<<" s   Moves/s: "<<\
+                ((result.seconds>0)?result.n_moves/result.seconds:0)<<endl;
+                if(result.playout_length_a>=0 || result.playout_length_b>=0){
+                    cout<<"  Average length of the random games (moves until a player connects): A "<<\
+                    result.playout_length_a<<"   B "<<result.playout_length_b<<"   (-1 = not counted)"<<endl;
                 }
                 return;
             }
 
-            bool get_path_was_seeked(){
-                return path_was_seeked;
+            static pair<double, double> wilson_interval(int wins, int n_games, double z=1.96){ // Confidence interval
+            // of a ratio of victories (z = 1.96 for 95%). Unlike p +- z*sqrt(p(1-p)/n), it stays inside [0, 1]
+            // and doesn't shrink to a point when a side wins every game
+                if(n_games==0){
+                    return pair<double, double>(0, 1);
+                }
+                double p = static_cast<double>(wins)/n_games;
+                double denominator = 1+z*z/n_games;
+                double center = (p+z*z/(2*n_games))/denominator;
+                double half_width = z*sqrt(p*(1-p)/n_games+z*z/(4.0*n_games*n_games))/denominator;
+                return pair<double, double>(max(0.0, center-half_width), min(1.0, center+half_width));
             }
 
-            bool get_path_exists(){
-                return path_exists;
+            static string elo_text(double ratio){ // Elo difference which corresponds to a ratio of victories
+                if(ratio<=0){
+                    return "-inf";
+                }else if(ratio>=1){
+                    return "+inf";
+                }
+                ostringstream text;
+                double elo = round(-400*log10(1/ratio-1)*10)/10;
+                if(elo==0){ // (No "-0.0" at a ratio of 0.5 or just below it)
+                    elo = 0;
+                }
+                text<<((elo>=0)?"+":"")<<fixed<<setprecision(1)<<elo;
+                return text.str();
             }
 
-            void print_path(){
-                if(path_was_seeked==true){
-                    if(path_exists==true){
-                        cout<<"\n### Shortest path from node "<<nodeFrom<<" to node "<<nodeTo<<":"<<endl;   
-                        cout<<"    "<<nodeFrom<<" (0) -> ";
-                        for(int i=0; i<shortest_path.size(); ++i){
-                            cout<<shortest_path[i].get_value1()<<" ("<<shortest_path[i].get_value2()<<")";
-                            if(i<shortest_path.size()-1){cout<<" -> ";}
-                        }                     
-                        cout<<"\n# Total cost of the path: "<<shortest_path_cost<<endl;
-                    }else{
-                        cout<<"### NO POSSIBLE PATH EXISTS from node "<<nodeFrom<<" to node "<<nodeTo<<" !"<<endl;
-                    }
-                }else{
-                    cout<<"### Shortest path hasn't been seeked yet!"<<endl;
+        private:
+            static double average_playout_length(const vector<MonteCarlo_Bot>& bots){ // (-1 without early cutoff)
+                long n_playouts = 0;
+                long n_moves = 0;
+                for(const MonteCarlo_Bot& bot : bots){
+                    n_playouts += bot.get_n_cut_playouts();
+                    n_moves += bot.get_n_playout_moves();
                 }
-                return;
+                return (n_playouts>0)?static_cast<double>(n_moves)/n_playouts:-1;
             }
 
-            vector<int_and_num_Pair<numType>> get_path(){
-                if(path_was_seeked==true){
-                    if(path_exists==true){
-                        return shortest_path;
+            bool a_wins(int game, int winner) const{ // A is player 1 in the even games
+                return (winner==1)==(game%2==0);
+            }
+
+            const Engine_Settings& engine(int game, int player) const{ // The engine which is this player in this game
+                return ((player==1)==(game%2==0))?engine_a:engine_b;
+            }
+
+            Game_State play_game(int game, MonteCarlo_Bot& bot_a, MonteCarlo_Bot& bot_b, array<double, 3>& seconds){
+                // (seconds[player] adds the time that each player's engine spends choosing its moves)
+                Game_State state(border_length, 1);
+                while(state.get_winner()==0){
+                    int player = state.get_position().get_side_to_move();
+                    MonteCarlo_Bot& bot = ((player==1)==(game%2==0))?bot_a:bot_b;
+                    auto move_start = chrono::steady_clock::now();
+                    Bot_Move move = choose_move(bot, state);
+                    seconds[player] += chrono::duration<double>(chrono::steady_clock::now()-move_start).count();
+                    if(move.is_swap){
+                        state.swap(move.node);
                     }else{
-                        cout<<"NO POSSIBLE PATH EXISTS from node "<<nodeFrom<<" to node "<<nodeTo<<" ! Returning empty vector."<<endl;
-                        return vector<int_and_num_Pair<numType>>();
+                        state.play(move.node);
                     }
-                }else{
-                    cout<<"Shortest path hasn't been seeked yet! Returning empty vector."<<endl;
-                    return vector<int_and_num_Pair<numType>>();
                 }
+                return state;
             }
 
-            numType get_path_cost(){
-                if(path_was_seeked==true){
-                    if(path_exists==true){
-                        return shortest_path_cost;
-                    }else{
-                        cout<<"NO POSSIBLE PATH EXISTS from node "<<nodeFrom<<" to node "<<nodeTo<<" ! Returning -1."<<endl;
-                        return -1;
+            Bot_Move choose_move(MonteCarlo_Bot& bot, const Game_State& state){ // The bot's move for the player to
+            // move. (Player 1 never moves second, so the swap is only possible for player 2)
+                if(state.get_position().get_side_to_move()==2){
+                    return bot.choose_move(state);
+                }
+                Position image = state.get_position().transposed();
+                vector<int> empty_cells;
+                for(int node : state.get_empty_cells()){
+                    empty_cells.push_back(image.transpose_node(node));
+                }
+                Bot_Move move = bot.choose_move(image, empty_cells, state.get_moves().size()+1);
+                move.node = image.transpose_node(move.node);
+                for(auto& candidate : move.nodes_and_ratios){
+                    candidate.first = image.transpose_node(candidate.first);
+                }
+                return move;
+            }
+
+            int border_length;
+            bool swap_rule;
+            int n_games;
+            Engine_Settings engine_a;
+            Engine_Settings engine_b;
+            int n_threads;
+            Game_Log_Writer* game_log; // (nullptr if the games aren't saved)
+            Pattern_Policy policy; // Shared by the bots which use the patterns (they only read it)
+    };
+
+    // ===============================================================================================
+    // class Position_Analyzer
+    // ===============================================================================================
+    class Position_Analyzer{
+        // Batch mode of the bot's evaluation: reads positions, one per line in the text form of
+        // Position::to_text() optionally followed by the player to move (1 or 2), and writes the ratio of
+        // victories of the player to move for each empty cell, as the bot computes it before choosing its
+        // move (player 1's ratios are computed on the transposed position). Empty lines, lines starting
+        // with '#' and positions which are already decided (a player has connected, or the board is full)
+        // are skipped.
+        // The positions are evaluated by n_threads worker threads, which are started once and take them
+        // from a queue filled by the reading thread. At most QUEUE_PER_THREAD positions per thread are
+        // in flight (queued, being evaluated or waiting for an earlier one), so the memory used doesn't
+        // depend on the number of positions. Each result is written, in the input order, as soon as the
+        // results before it are done. Every position is given its own seed when it's read, so its ratios
+        // don't depend on the thread which evaluates it nor on the number of threads.
+        // CSV: one line per empty cell (position,border_length,side_to_move,node,x,y,ratio).
+        // JSON: an array with one object per position, with its board, the bot's move and its cells.
+
+        public:
+            static int const QUEUE_PER_THREAD = 8;
+
+            Position_Analyzer(int n_iterations=N_MC_ITERATIONS, bool json=false, int n_threads=0):\
+            n_iterations(n_iterations),json(json),n_threads(n_threads){
+                if(this->n_threads<=0){
+                    this->n_threads = max(1u, thread::hardware_concurrency());
+                }
+            }
+
+            long run(istream& input, ostream& output){ // Returns the number of positions analyzed
+                // One bot per thread, reseeded for each position. They give every cell the same number of
+                // random games, as all of the ratios are wanted (not just the best move):
+                vector<MonteCarlo_Bot> bots(n_threads, MonteCarlo_Bot(false, n_iterations));
+                for(MonteCarlo_Bot& bot : bots){
+                    bot.set_sequential_halving(false);
+                }
+                long line_number = 0;
+                bool first_record = true;
+                if(json){
+                    output<<"["<<endl;
+                }else{
+                    output<<"position,border_length,side_to_move,node,x,y,ratio"<<endl;
+                }
+                long capacity = static_cast<long>(n_threads)*QUEUE_PER_THREAD;
+                queue<Job> pending; // Positions read and not yet taken by a worker
+                unordered_map<long, string> done; // Records finished before an earlier one
+                long n_read = 0;
+                long n_written = 0;
+                bool end_of_input = false;
+                mutex queue_mutex; // (For all of the above and for the output)
+                condition_variable position_ready; // (Workers wait for it)
+                condition_variable slot_free; // (The reading thread waits for it)
+                auto worker = [&](int t){
+                    unique_lock<mutex> lock(queue_mutex);
+                    while(true){
+                        position_ready.wait(lock, [&]{return !pending.empty() || end_of_input;});
+                        if(pending.empty()){
+                            return;
+                        }
+                        Job job = move(pending.front());
+                        pending.pop();
+                        lock.unlock();
+                        bots[t].set_seed(job.seed);
+                        string record = analyze(bots[t], job.position, job.index);
+                        lock.lock();
+                        done[job.index] = move(record);
+                        for(auto next = done.find(n_written); next!=done.end(); next = done.find(n_written)){
+                            if(json){
+                                output<<(first_record?"":",\n")<<"  "<<next->second;
+                                first_record = false;
+                            }else{
+                                output<<next->second;
+                            }
+                            done.erase(next);
+                            ++n_written;
+                        }
+                        slot_free.notify_one();
+                    }
+                };
+                vector<thread> workers;
+                for(int t=0; t<n_threads; ++t){
+                    workers.push_back(thread(worker, t));
+                }
+                string line;
+                while(getline(input, line)){
+                    ++line_number;
+                    istringstream fields(line); // "<cells> [side_to_move]"
+                    string cells;
+                    string side;
+                    if(!(fields>>cells) || cells[0]=='#'){
+                        continue;
                     }
+                    fields>>side;
+                    Position position;
+                    if(!Position::from_text(cells, position, atoi(side.c_str()))){
+                        cout<<"Line "<<line_number<<" isn't a valid position. Skipping it."<<endl;
+                        continue;
+                    }
+                    if(position.has_connection(1) || position.has_connection(2) || position.get_move_count()>=position.V()){
+                        cout<<"Line "<<line_number<<" is an already decided position. Skipping it."<<endl;
+                        continue;
+                    }
+                    Job job;
+                    job.index = n_read;
+                    job.seed = gen();
+                    job.position = move(position);
+                    unique_lock<mutex> lock(queue_mutex);
+                    slot_free.wait(lock, [&]{return n_read-n_written<capacity;});
+                    pending.push(move(job));
+                    ++n_read;
+                    position_ready.notify_one();
+                }
+                {
+                    lock_guard<mutex> lock(queue_mutex);
+                    end_of_input = true;
+                }
+                position_ready.notify_all();
+                for(thread& aux : workers){
+                    aux.join();
+                }
+                long n_analyzed = n_written;
+                if(json){
+                    output<<(first_record?"":"\n")<<"]"<<endl;
+                }
+                return n_analyzed;
+            }
+
+            Bot_Move evaluate(MonteCarlo_Bot& bot, const Position& position){ // The bot's move for the player to move
+            // (see MonteCarlo_Bot::choose_move), with the ratio of victories of each empty cell, sorted by node
+                Bot_Move move;
+                int movement = position.get_move_count()+1;
+                if(position.get_side_to_move()==2){
+                    move = bot.choose_move(position, bot.get_unused_nodes(position), movement);
                 }else{
-                    cout<<"Shortest path hasn't been seeked yet! -1"<<endl;
-                    return -1;
+                    Position image = position.transposed();
+                    move = bot.choose_move(image, bot.get_unused_nodes(image), movement);
+                    if(move.node>=0){ // (-1 if there are no empty cells)
+                        move.node = image.transpose_node(move.node);
+                    }
+                    for(auto& candidate : move.nodes_and_ratios){
+                        candidate.first = image.transpose_node(candidate.first);
+                    }
                 }
+                sort(move.nodes_and_ratios.begin(), move.nodes_and_ratios.end());
+                return move;
             }
 
         private:
-            int_int_and_num_Triad<numType>
-            join_current_and_neighbor_and_cost(int currentNode, int_and_num_Pair<numType> neighbor){
-                return int_int_and_num_Triad<numType>(currentNode, neighbor.get_value1(), neighbor.get_value2());
+            struct Job{ // A position waiting for a worker
+                long index; // (In the output)
+                uint32_t seed;
+                Position position;
+            };
+
+            string analyze(MonteCarlo_Bot& bot, const Position& position, long index){
+                Bot_Move move = evaluate(bot, position);
+                const vector<pair<int, double>>& nodes_and_ratios = move.nodes_and_ratios;
+                const BoardTopology& topology = position.get_topology();
+                ostringstream record;
+                if(json){
+                    record<<"{\"position\": "<<index<<", \"board\": \""<<position.to_text()<<"\", \"border_length\": "<<\
+                    position.get_border_length()<<", \"side_to_move\": "<<position.get_side_to_move()<<", \"best\": "<<\
+                    move.node<<", \"cells\": [";
+                    for(int k=0; k<nodes_and_ratios.size(); ++k){
+                        pair<int, int> xy = topology.nodeIndex_to_coordinate(nodes_and_ratios[k].first);
+                        record<<((k>0)?", ":"")<<"{\"node\": "<<nodes_and_ratios[k].first<<", \"x\": "<<xy.first<<\
+                        ", \"y\": "<<xy.second<<", \"ratio\": "<<nodes_and_ratios[k].second<<"}";
+                    }
+                    record<<"]}";
+                }else{
+                    for(auto& candidate : nodes_and_ratios){
+                        pair<int, int> xy = topology.nodeIndex_to_coordinate(candidate.first);
+                        record<<index<<","<<position.get_border_length()<<","<<position.get_side_to_move()<<","<<\
+                        candidate.first<<","<<xy.first<<","<<xy.second<<","<<candidate.second<<"\n";
+                    }
+                }
+                return record.str();
             }
 
-            void reproduce_found_path(){
-                // This method examines the vector of used elements of the queue and
-                // extracts the steps done, looking in reverse node order (from nodeTo to
-                // nodeFrom) and choosing those of least total cost. This way, we have
-                // a vector which has, in order, the nodes which conform the shortest path.
-                vector<PriorityQueue<numType>> elements_of_each_destination_node;
-                for(int i=0; i<graph.V(); ++i){ // (graph.V() returns the size of the graph)
-                    elements_of_each_destination_node.push_back(PriorityQueue<numType>());
-                    for(int k=0; k<used_queue_elements.size(); ++k){
-                        if(used_queue_elements[k].get_value2()==i){
-                            elements_of_each_destination_node[i].insert(used_queue_elements[k]);
+            int n_iterations;
+            bool json;
+            int n_threads;
+    };
+
+    // ===============================================================================================
+    // class Graph_Benchmark
+    // ===============================================================================================
+    class Graph_Benchmark{
+        // Offline tool which measures the graph classes used as a general library: random
+        // undirected_Graph<double> objects of sizes 10^2, 10^3, ... up to max_size, for several densities
+        // and both representations. For each graph, it measures the construction, neighbors() (all
+        // nodes, or a sample on big graphs), E(), adjacent() on random pairs, ShortestPath::seek_path
+        // on random pairs and the copy constructor. The results are printed as CSV or JSON, one record
+        // per graph (times in milliseconds for whole operations and in nanoseconds per call otherwise;
+        // -1 means not measured).
+        // Graphs which wouldn't fit in memory are skipped: the connectivity matrix is only built up to
+        // MAX_MATRIX_ELEMENTS elements and the edge list up to MAX_LIST_ENTRIES expected entries.
+        // seek_path is only measured up to MAX_SEEK_PATH_SIZE nodes, as its cost grows quickly.
+
+        public:
+            static long const MAX_MATRIX_ELEMENTS = 10000000;
+            static long const MAX_LIST_ENTRIES = 20000000;
+            static int const MAX_SEEK_PATH_SIZE = 1000;
+            static int const N_SAMPLES = 1000; // Calls of neighbors(), adjacent() and E() for each graph
+            static int const N_SEEK_PATH_SAMPLES = 2;
+
+            Graph_Benchmark(int max_size=1000000, bool json=false):max_size(max_size),json(json){}
+
+            void run(){
+                double const densities[] = {0.00001, 0.0001, 0.001, 0.01, 0.1, 0.5};
+                representationMode const modes[] = {CON_MATRIX, EDGE_LIST};
+                vector<string> records;
+                for(long size=100; size<=max_size; size*=10){
+                    for(representationMode mode : modes){
+                        for(double density : densities){
+                            double expected_entries = density*size*(size-1);
+                            if(expected_entries<size){ // (Almost no edges: nothing to measure)
+                                continue;
+                            }
+                            if(mode==CON_MATRIX && size*size>MAX_MATRIX_ELEMENTS){
+                                continue;
+                            }
+                            if(expected_entries>MAX_LIST_ENTRIES){
+                                continue;
+                            }
+                            records.push_back(measure(size, density, mode));
                         }
                     }
                 }
-                // Now, we have to iterate through elements_of_each_destination_node, starting on
-                // elements_of_each_destination_node[nodeTo] and using
-                // elements_of_each_destination_node[nodeTo].get_value1() for next element, and so on:
-                currentNode = nodeTo;
-                int_int_and_num_Triad<numType> rawAux;
-                while(currentNode!=nodeFrom){
-                    rawAux = elements_of_each_destination_node[currentNode].get_top_NotDelete();
-                    raw_shortest_path.insert(raw_shortest_path.begin(), rawAux); // This is insert at the top
-                    currentNode = rawAux.get_value1();
-                }
-                numType previous_cost = 0;
-                numType current_cost = 0;
-                numType step_cost = 0;
-                for(int i=0; i<raw_shortest_path.size(); ++i){
-                    int_and_num_Pair<numType> pairAux;
-                    pairAux.set_value1(raw_shortest_path[i].get_value2());
-                    current_cost = raw_shortest_path[i].get_value3();
-                    step_cost = current_cost - previous_cost;
-                    pairAux.set_value2(step_cost);
-                    shortest_path.push_back(pairAux);
-                    previous_cost = current_cost;
+                if(json){
+                    cout<<"["<<endl;
+                    for(int i=0; i<records.size(); ++i){
+                        cout<<"  "<<records[i]<<((i<records.size()-1)?",":"")<<endl;
+                    }
+                    cout<<"]"<<endl;
+                }else{
+                    cout<<"representation,size,density,edges,construction_ms,neighbors_ns,E_ns,adjacent_ns,seek_path_us,"<<\
+                    "copy_ms"<<endl;
+                    for(string& record : records){
+                        cout<<record<<endl;
+                    }
                 }
-                shortest_path_cost = current_cost;
                 return;
             }
 
         private:
-            int nodeFrom;
-            int nodeTo;
-            int currentNode;
-            graphType &graph;
-            bool terminated;
-            bool path_was_seeked;
-            bool path_exists;
-            bool nodeTo_was_visited;
-            vector<int> open_set; // Set where to store the still UNVISITED nodes
-            vector<int> closed_set; // Set where to store the VISITED nodes
-            vector<numType> tentative_costs; // Stores the cost it takes from the nodeFrom to each node up to now
-            vector<int_and_num_Pair<numType>> neighbors;
-            PriorityQueue<numType> queue;
-            int_int_and_num_Triad<numType> last_top_of_queue;
-            vector<int_int_and_num_Triad<numType>> used_queue_elements; // This will store the elements of the queue which
-            // have been used. This is necessary to reproduce the path found, once the algorithm has finished.
-            vector<int_and_num_Pair<numType>> shortest_path;
-            numType shortest_path_cost;
-            vector<int_int_and_num_Triad<numType>> raw_shortest_path; // Auxiliary vector to store the steps of the path before processing them
+            string measure(int size, double density, representationMode mode){
+                // The graph classes report their work on cout, so it's silenced while measuring:
+                ostringstream silenced;
+                streambuf* cout_buffer = cout.rdbuf(silenced.rdbuf());
+
+                auto start = chrono::steady_clock::now();
+                undirected_Graph<double> graph(size, static_cast<float>(density), mode);
+                double construction_ms = elapsed_ns(start)/1e6;
+
+                uniform_int_distribution<int> random_node(0, size-1);
+                int n_neighbors_calls = min(size, static_cast<int>(N_SAMPLES));
+                long checksum = 0; // (So that the compiler doesn't discard the calls)
+                start = chrono::steady_clock::now();
+                for(int i=0; i<n_neighbors_calls; ++i){
+                    checksum += graph.neighbors((size==n_neighbors_calls)?i:random_node(gen)).size();
+                }
+                double neighbors_ns = elapsed_ns(start)/n_neighbors_calls;
+
+                start = chrono::steady_clock::now();
+                for(int i=0; i<N_SAMPLES; ++i){
+                    checksum += graph.E();
+                }
+                double E_ns = elapsed_ns(start)/N_SAMPLES;
+
+                vector<pair<int,int>> pairs;
+                for(int i=0; i<N_SAMPLES; ++i){
+                    pairs.push_back(pair<int,int>(random_node(gen), random_node(gen)));
+                }
+                start = chrono::steady_clock::now();
+                for(auto& nodes : pairs){
+                    checksum += graph.adjacent(nodes.first, nodes.second);
+                }
+                double adjacent_ns = elapsed_ns(start)/N_SAMPLES;
+
+                double seek_path_us = -1;
+                if(size<=MAX_SEEK_PATH_SIZE){
+                    ShortestPath<undirected_Graph<double>, double> path(graph);
+                    start = chrono::steady_clock::now();
+                    for(int i=0; i<N_SEEK_PATH_SAMPLES; ++i){
+                        path.seek_path(pairs[i].first, pairs[i].second);
+                        checksum += path.get_path_exists();
+                    }
+                    seek_path_us = elapsed_ns(start)/1e3/N_SEEK_PATH_SAMPLES;
+                }
+
+                start = chrono::steady_clock::now();
+                undirected_Graph<double> copy(graph);
+                double copy_ms = elapsed_ns(start)/1e6;
+                checksum += copy.V();
+
+                cout.rdbuf(cout_buffer);
+                if(checksum<0){ // (Never happens)
+                    cout<<checksum<<endl;
+                }
+
+                string representation = (mode==CON_MATRIX)?"CON_MATRIX":"EDGE_LIST";
+                ostringstream record;
+                if(json){
+                    record<<"{\"representation\": \""<<representation<<"\", \"size\": "<<size<<", \"density\": "<<density<<\
+                    ", \"edges\": "<<graph.E()<<", \"construction_ms\": "<<construction_ms<<", \"neighbors_ns\": "<<\
+                    neighbors_ns<<", \"E_ns\": "<<E_ns<<", \"adjacent_ns\": "<<adjacent_ns<<", \"seek_path_us\": "<<\
+                    seek_path_us<<", \"copy_ms\": "<<copy_ms<<"}";
+                }else{
+                    record<<representation<<","<<size<<","<<density<<","<<graph.E()<<","<<construction_ms<<","<<\
+                    neighbors_ns<<","<<E_ns<<","<<adjacent_ns<<","<<seek_path_us<<","<<copy_ms;
+                }
+                return record.str();
+            }
+
+            static double elapsed_ns(chrono::steady_clock::time_point start){
+                return chrono::duration<double, nano>(chrono::steady_clock::now()-start).count();
+            }
+
+            long max_size;
+            bool json;
     };
 
     // ===============================================================================================
@@ -1578,10 +5659,10 @@ namespace Graph{
             // Constructors:
             // =============
             Hex_Game(int border_length, int who_starts, bool vs_robot,\
-            bool swap_rule):board(Hex_Board(border_length)),border_length(border_length),\
+            bool swap_rule):state(border_length,who_starts),border_length(border_length),bot(swap_rule),solver(border_length),\
             this_is_movement_number(1),swap_has_been_done(false),\
             game_finished(false),who_won(0),who_starts(who_starts),vs_robot(vs_robot),\
-            swap_rule(swap_rule){
+            swap_rule(swap_rule),bot_time_ms(0),show_heatmap(false){
                 cout<<"Welcome to Hex game!"<<endl;
                 cout<<"====================\n"<<endl;
                 cout<<"You will be playing on a "<<border_length<<" x "<<border_length<<" board."<<endl;
@@ -1601,9 +5682,9 @@ namespace Graph{
                 }
             }
 
-            Hex_Game(int border_length=11):board(Hex_Board(border_length)),border_length(border_length),\
-            this_is_movement_number(1),swap_has_been_done(false),\
-            game_finished(false),who_won(0){ // Default constructor
+            Hex_Game(int border_length=11):state(border_length),border_length(border_length),\
+            solver(border_length),this_is_movement_number(1),swap_has_been_done(false),\
+            game_finished(false),who_won(0),bot_time_ms(0),show_heatmap(false){ // Default constructor
                 for(int i=0; i<100; ++i){cout<<endl;} // clearing the screen
                 cout<<"Welcome to Hex game!"<<endl;
                 cout<<"====================\n"<<endl;
@@ -1650,6 +5731,7 @@ namespace Graph{
                     swap_rule = true;
                     cout<<">> Invalid input. Swap rule is enabled.\n"<<endl;
                 }
+                bot = MonteCarlo_Bot(swap_rule);
             }
 
             // Class methods:
@@ -1662,10 +5744,30 @@ namespace Graph{
                 int y;
                 cout<<"\n>>>> Player "<<player<<", choose a square to move."<<endl;
                 while(!valid){
-                    cout<<">> Enter x coordinate."<<endl;
+                    cout<<">> Enter x coordinate (or u to take back the last move of each player, r to play them again,"<<\
+                    " h to show or hide the heatmap of the bot)."<<endl;
                     sub_valid = false;
                     while(!sub_valid){
                         cin>>aux;
+                        if(aux=="h"){
+                            show_heatmap = !show_heatmap;
+                            draw_board();
+                            if(show_heatmap && last_heatmap.get_best_node()<0){
+                                cout<<"-- The bot hasn't evaluated this position."<<endl;
+                            }
+                            cout<<">> Enter x coordinate."<<endl;
+                            continue;
+                        }
+                        if(aux=="u" || aux=="r"){
+                            if(aux=="u"?undo_turn():redo_turn()){
+                                draw_board();
+                            }else{
+                                cout<<"-- There are no moves to "<<(aux=="u"?"take back":"play again")<<"."<<endl;
+                            }
+                            cout<<"\n>>>> Player "<<player<<", choose a square to move."<<endl;
+                            cout<<">> Enter x coordinate."<<endl;
+                            continue;
+                        }
                         for(int k=0; k<border_length; ++k){
                             if(aux==to_string(k)){
                                 sub_valid = true;
@@ -1694,7 +5796,7 @@ namespace Graph{
                         }
                     }
 
-                    int nodeTag = board.get_node_tag_byCoordinates(x,y);
+                    int nodeTag = state.get_position().get_node_tag_byCoordinates(x,y);
                     if(nodeTag==0){ // Node tag has to be 0 (default). 1 would be a player 1's
                     // previous movement and 2 would be a player 2's previous movement.
                         valid = true;
@@ -1705,16 +5807,11 @@ namespace Graph{
                     }
                 }
                 
-                board.set_node_tag_byCoordinates(x,y,player);
+                state.set_side_to_move(player);
+                state.play(state.get_position().get_topology().coordinate_to_nodeIndex(x,y));
                 cout<<"Player "<<player<<" has moved.\n"<<endl;
 
-                board.draw_board_ASCII(false);
-
-                if(player==1){
-                    player_1_moves.push_back(pair<int,int>(x,y));
-                }else{
-                    player_2_moves.push_back(pair<int,int>(x,y));
-                }
+                draw_board();
 
                 if(this_is_movement_number==1 && swap_rule && !(who_starts==1 && vs_robot==true)){
                     cout<<"\n>>>> Player "<<(player%2)+1<<", do you want to use SWAP (y/n)?"<<endl;
@@ -1734,17 +5831,9 @@ namespace Graph{
 
                     if(wanna_swap){
                         swap_has_been_done = true;
-                        if(player==1){
-                            player_1_moves.clear();
-                            player_2_moves.push_back(pair<int,int>(x,y));
-                            board.set_node_tag_byCoordinates(x,y,2);
-                        }else{
-                            player_2_moves.clear();
-                            player_1_moves.push_back(pair<int,int>(x,y));
-                            board.set_node_tag_byCoordinates(x,y,1);
-                        }
+                        state.swap(state.get_position().get_topology().coordinate_to_nodeIndex(x,y));
 
-                        board.draw_board_ASCII(false);
+                        draw_board();
                     }
                 }
                     
@@ -1765,89 +5854,106 @@ namespace Graph{
                 return;
             }
 
-            bool check_bot_won(Hex_Board &_board){ // Special "check_connection_lateral" method, for the bot's implementation
-                // Check if there is a path between any of the nodes of the West border and
-                // any of the nodes of the East border, considering only nodes of player 2 ("O")
-                // and using Dijkstra's shortest path algorithm
-                bool connects = false;
-                ShortestPath<Hex_Board, int> path(_board);
-                vector<int> avoid_these_tags;
-                avoid_these_tags.push_back(0);
-                avoid_these_tags.push_back(1);
-                for(int w=0; w<_board.get_border_length(); ++w){
-                    for(int e=0; e<_board.get_border_length(); ++e){
-                        int nodeFrom = _board.coordinate_to_nodeIndex(w,0);
-                        int nodeTo = _board.coordinate_to_nodeIndex(e,_board.get_border_length()-1);
-                        path.seek_path(nodeFrom, nodeTo, avoid_these_tags);
-                        if(path.get_path_exists()){
-                            connects = true;
-                            break;
-                        }
-                    }
-                    if(connects){
-                        break;
-                    }
-                }
-                return connects;
+            bool check_bot_won(const Position& _position){ // Special "check_connection_lateral" method, for the bot's implementation
+                return bot.check_bot_won(_position);
             }
 
             bool check_connection_vertical(){
-                // Check if there is a path between any of the nodes of the North border and
-                // any of the nodes of the South border, considering only nodes of player 1 ("X")
-                // and using Dijkstra's shortest path algorithm
-                bool connects = false;
-                ShortestPath<Hex_Board, int> path(board);
-                vector<int> avoid_these_tags;
-                avoid_these_tags.push_back(0);
-                avoid_these_tags.push_back(2);
-                for(int n=0; n<border_length; ++n){
-                    for(int s=0; s<border_length; ++s){
-                        int nodeFrom = board.coordinate_to_nodeIndex(0,n);
-                        int nodeTo = board.coordinate_to_nodeIndex(border_length-1,s);
-                        path.seek_path(nodeFrom, nodeTo, avoid_these_tags);
-                        if(path.get_path_exists()){
-                            connects = true;
-                            break;
-                        }
-                    }
-                    if(connects){
-                        break;
-                    }
-                }
-                return connects;
+                // Check if the stones of player 1 ("X") connect the North and South borders (O(1), the groups
+                // of stones are kept up to date by the game state)
+                return state.has_connection(1);
             }
 
             bool check_connection_lateral(){
-                // Check if there is a path between any of the nodes of the West border and
-                // any of the nodes of the East border, considering only nodes of player 2 ("O")
-                // and using Dijkstra's shortest path algorithm
-                bool connects = false;
-                ShortestPath<Hex_Board, int> path(board);
-                vector<int> avoid_these_tags;
-                avoid_these_tags.push_back(0);
-                avoid_these_tags.push_back(1);
-                for(int w=0; w<border_length; ++w){
-                    for(int e=0; e<border_length; ++e){
-                        int nodeFrom = board.coordinate_to_nodeIndex(w,0);
-                        int nodeTo = board.coordinate_to_nodeIndex(e,border_length-1);
-                        path.seek_path(nodeFrom, nodeTo, avoid_these_tags);
-                        if(path.get_path_exists()){
-                            connects = true;
-                            break;
-                        }
-                    }
-                    if(connects){
-                        break;
-                    }
+                // Check if the stones of player 2 ("O") connect the West and East borders (O(1), see above)
+                return state.has_connection(2);
+            }
+
+            bool undo_turn(){ // Takes back the last move of each player, so that the same player is to move
+            // again. False if there aren't two moves to take back
+                if(state.get_moves().size()<2){
+                    return false;
+                }
+                state.undo();
+                state.undo();
+                after_undo_or_redo();
+                cout<<">> The last two moves have been taken back.\n"<<endl;
+                return true;
+            }
+
+            bool redo_turn(){ // Plays again the two moves taken back by undo_turn()
+                if(state.get_n_redo_moves()<2){
+                    return false;
+                }
+                state.redo();
+                state.redo();
+                after_undo_or_redo();
+                cout<<">> The last two moves have been played again.\n"<<endl;
+                return true;
+            }
+
+            void after_undo_or_redo(){ // The counters of the game are recomputed from the moves in the stack
+                this_is_movement_number = state.get_moves().size()+1;
+                last_heatmap = Heatmap(); // (It was computed for another position)
+                swap_has_been_done = false;
+                for(const Game_State::Move& move : state.get_moves()){
+                    swap_has_been_done = swap_has_been_done || move.is_swap;
+                }
+                return;
+            }
+
+            const Heatmap& get_last_heatmap() const{ // Ratios of victories of the candidates of the last bot move
+            // (empty if the bot hasn't evaluated the current position)
+                return last_heatmap;
+            }
+
+            void draw_board(){ // With the heatmap of the last bot move, if it's shown
+                state.get_position().draw_board_ASCII(false, show_heatmap?&last_heatmap:nullptr);
+                return;
+            }
+
+            void save_game(){ // Appends the finished game to the game log
+                Game_Record record = Game_Record::from_state(state, swap_rule);
+                record.winner = who_won;
+                if(vs_robot){
+                    record.n_iterations = bot.get_n_iterations();
+                    record.bot_time_ms = bot_time_ms;
                 }
-                return connects;
+                Game_Log_Writer log;
+                if(log.open(Game_Log_Writer::default_filename()) && log.write(record)){
+                    cout<<"\n>> Game saved to "<<Game_Log_Writer::default_filename()<<"."<<endl;
+                }
+                return;
+            }
+
+            string solver_cache_filename() const{ // File where the solved positions of this board size are kept
+                return "hex_solver_cache_"+to_string(border_length)+"x"+to_string(border_length)+".bin";
             }
 
             void game_loop(){ // This is the loop which runs the game.
 
-                board.draw_board_ASCII(false);
+                state.set_side_to_move(who_starts);
+                draw_board();
                 
                 if(vs_robot){
+                    // The positions solved in previous games are reused:
+                    if(border_length<=MAX_SOLVER_BORDER_LENGTH && solver.load_cache(solver_cache_filename())){
+                        cout<<">> Exact solver cache loaded ("<<solver.get_cache_size()<<" solved positions).\n"<<endl;
+                    }
+                    // And so is the opening book of this board size, if it has been generated:
+                    if(book.open(Opening_Book::default_filename(border_length))){
+                        if(book.get_border_length()!=border_length || book.get_swap_rule()!=swap_rule){
+                            book.close(); // It was built for other settings
+                        }else{
+                            cout<<">> Opening book loaded ("<<book.size()<<" positions).\n"<<endl;
+                        }
+                    }
+                    // And the pattern weights which guide the random games of the bot:
+                    if(policy.load(Pattern_Policy::default_filename())){
+                        bot.set_policy(&policy);
+                        cout<<">> Pattern weights loaded.\n"<<endl;
+                    }
+
                     int current_player = who_starts;
                     while(!game_finished){
                         if(current_player==1){
@@ -1869,15 +5975,11 @@ namespace Graph{
 
                                 if(wanna_swap){
                                     swap_has_been_done = true;
-                                    int x = player_2_moves[0].first;
-                                    int y = player_2_moves[0].second;
-                                    player_2_moves.clear();
-                                    player_1_moves.push_back(pair<int,int>(x,y));
-                                    board.set_node_tag_byCoordinates(x,y,1);
+                                    state.swap(state.get_moves().back().node); // (The first move of the bot)
 
                                     ++this_is_movement_number;
                                     
-                                    board.draw_board_ASCII(false);
+                                    draw_board();
                                 }
                             }else{player_move_by_input(current_player);}
                             
@@ -1885,134 +5987,69 @@ namespace Graph{
 
                         }else{
                             cout<<"\n>>>> Robot player 2 is choosing its move. Please wait...\n...\n..."<<endl;
+                            auto bot_start = chrono::steady_clock::now();
+                            Hex_Board board = state.get_position().to_board(); // (For the solver and the book)
 
-                            // Check what nodes haven't been already played
-                            vector<int> unused_nodes;
-                            vector<int> shufflable;
-                            for(int i=0; i<board.V(); ++i){
-                                if(board.get_node_tag(i)==0){
-                                    unused_nodes.push_back(i);
-                                    shufflable.push_back(i);
-                                }
-                            }
-                                                
-                            // Now, for each possible movement, run the Monte Carlo computation
-                            vector<pair<int, double>> nodes_and_ratios;
-                            for(auto fixed_possible_node : unused_nodes){
-                                int bot_victories = 0;
-                                int human_victories = 0;
-                                double ratio_bot_victories = 0;
-                                for(int it = 0; it<N_MC_ITERATIONS; ++it){
-                                    int aux_current_player = 2; // (initialize to 2, it's the robot's move)
-                                    Hex_Board* aux_board = new Hex_Board(this->board); // Copy-constructed
-                                    aux_board->set_node_tag(fixed_possible_node, aux_current_player); // Mark the fixed move on the auxiliary board
-                                    shuffle(begin(shufflable), end(shufflable), randengine); // Shuffle the vector in a random order
-                                    
-                                    int aux_this_is_movement_number = this_is_movement_number;
-                                    if(swap_rule){ // Possibility of swap
-                                        int aux_index = 0;
-                                        int nodes_examined = 0;
-                                        int aux_current_node = fixed_possible_node;
-                                        while(nodes_examined<shufflable.size()){
-                                            if(aux_this_is_movement_number==2 && aux_current_player==1 &&\
-                                            probability_using_swap(gen)<0.5){ // Player 1 randomly chooses whether to do swap or not
-                                                aux_board->set_node_tag(fixed_possible_node, aux_current_player);
-                                                aux_current_player = (aux_current_player%2)+1;
-                                            }else{
-                                                aux_board->set_node_tag(aux_current_node, aux_current_player);
-                                                aux_current_player = (aux_current_player%2)+1;
-                                                ++nodes_examined;
-                                                if(shufflable[aux_index] != fixed_possible_node){
-                                                    aux_current_node = shufflable[aux_index];
-                                                    ++aux_index;
-                                                }else{
-                                                    if(aux_index+1<shufflable.size()){
-                                                        aux_current_node = shufflable[aux_index+1];
-                                                        aux_index+=2;
-                                                    }
-                                                }
-                                            }
-                                            ++aux_this_is_movement_number;
-                                        }
-                                    }else{ // No swap permitted
-                                        for(auto next_node : shufflable){
-                                            if(next_node != fixed_possible_node){
-                                                aux_board->set_node_tag(next_node, aux_current_player);
-                                                aux_current_player = (aux_current_player%2)+1;
-                                                ++aux_this_is_movement_number;
-                                            }
-                                        }
-                                    }
-                                    // Check who won this Monte Carlo iteration:
-                                    if(check_bot_won(*aux_board)){ // Player 2 (bot) wins
-                                        ++bot_victories;
-                                    }else{ // DON'T CHECK THE CONNECTION AGAIN, BECAUSE IF PLAYER 2 HAS LOST, PLAYER 1 HAS WON!
-                                        ++human_victories;
-                                    }
-                                    delete aux_board; // As we have used a pointer, the aux board can be deleted after each Monte Carlo step
-                                    // and therefore we have a clean variable for the next iteration
-                                }
-                                ratio_bot_victories = static_cast<double>(bot_victories)/(bot_victories+human_victories);
-                                
-                                // Save the results of Monte Carlo runs for this fixed_possible_node:
-                                nodes_and_ratios.push_back(pair<int,double>(fixed_possible_node,ratio_bot_victories));
+                            // At move 2 with swap rule, the bot may capture player 1's first move (see
+                            // MonteCarlo_Bot::choose_move, which decides it with the precomputed swap map for the
+                            // board sizes it covers, or by simulation)
+                            int player1_first_move = -1;
+                            if(this_is_movement_number==2 && swap_rule){
+                                player1_first_move = state.get_moves().back().node;
                             }
 
-                            // Now, if the swap rule can be used, examine that special case:
-                            double ratio_bot_victories_with_swap = -1;
-                            int index_for_swap_rule = -999;
-                            int player1_first_move = -999;
-                            if(this_is_movement_number==2 && swap_rule){
-                                player1_first_move = board.coordinate_to_nodeIndex(player_1_moves[player_1_moves.size()-1].first,\
-                                player_1_moves[player_1_moves.size()-1].second);
-                                int bot_victories = 0;
-                                int human_victories = 0;
-                                for(int it = 0; it<N_MC_ITERATIONS; ++it){
-                                    int aux_current_player = 2; // (initialize to 2, it's the robot's move)
-                                    Hex_Board* aux_board = new Hex_Board(this->board); // Copy-constructed
-                                    aux_board->set_node_tag(player1_first_move, aux_current_player); // Undoing the Player 1's first move and marking
-                                    // it as Player 2's !
-                                    aux_current_player = (aux_current_player%2)+1; // After the swap, return the turn to the Player 1
-                                    shuffle(begin(shufflable), end(shufflable), randengine); // Shuffle the vector in a random order
-                                    for(auto next_node : shufflable){
-                                        if(next_node != player1_first_move){
-                                            aux_board->set_node_tag(next_node, aux_current_player);
-                                            aux_current_player = (aux_current_player%2)+1;
-                                        }
-                                    }
-                                    // Check who won this Monte Carlo iteration:
-                                    if(check_bot_won(*aux_board)){ // Player 2 (bot) wins
-                                        ++bot_victories;
-                                    }else{ // DON'T CHECK THE CONNECTION AGAIN, BECAUSE IF PLAYER 2 HAS LOST, PLAYER 1 HAS WON!
-                                        ++human_victories;
-                                    }
-                                    delete aux_board; // As we have used a pointer, the aux board can be deleted after each Monte Carlo step
-                                    // and therefore we have a clean variable for the next iteration
+                            // First, look for the position in the opening book. Early positions are the most
+                            // expensive ones for the Monte Carlo computation, as the board is almost empty.
+                            // (At move 2 with swap rule, the swap has to be decided, so the book isn't used)
+                            int book_move = -1;
+                            Book_Entry book_entry;
+                            if(book.is_open() && !(swap_rule && this_is_movement_number==2)){
+                                book_move = book.lookup(board, 2, &book_entry);
+                                if(book_move>=0){
+                                    cout<<">>>> Opening book move (estimated ratio of victories "<<book_entry.win_ratio<<")."<<endl;
                                 }
-                                ratio_bot_victories_with_swap = static_cast<double>(bot_victories)/(bot_victories+human_victories);
                             }
-                            
-                            // Examine all of the possible nodes, choose the most favorable one and mark it as the bot's move:
-                            int temp_index_of_max = nodes_and_ratios[0].first;
-                            double temp_max = nodes_and_ratios[0].second;
-                            if(nodes_and_ratios.size()>1){
-                                for(int i = 1; i<nodes_and_ratios.size();++i){
-                                    if(nodes_and_ratios[i].second>temp_max){
-                                        temp_index_of_max = nodes_and_ratios[i].first;
-                                        temp_max = nodes_and_ratios[i].second;
-                                    }
+
+                            // Then, on small boards, try to solve the position exactly. If the bot has a proven
+                            // win, it's played at once without spending the Monte Carlo budget. (The solver isn't
+                            // used if player 1 could still swap after this move, as it doesn't know that rule, nor
+                            // if the swap map already says that the bot should swap)
+                            int proven_winning_move = -1;
+                            if(book_move<0 && Swap_Map::decision(border_length, player1_first_move)!=1 &&\
+                            border_length<=MAX_SOLVER_BORDER_LENGTH && !(swap_rule && this_is_movement_number<2)){
+                                solverResult result = solver.solve(board, 2);
+                                if(result==SOLVER_WIN){
+                                    proven_winning_move = solver.get_winning_move();
+                                    cout<<">>>> Exact solver: Robot player 2 wins in all lines ("<<solver.get_nodes_searched()<<\
+                                    " nodes searched)."<<endl;
+                                }else if(result==SOLVER_LOSS){
+                                    cout<<">>>> Exact solver: Robot player 2 loses in all lines against perfect play ("<<\
+                                    solver.get_nodes_searched()<<" nodes searched)."<<endl;
                                 }
                             }
 
-                            // If swap rule is permitted and is benefitial, use it:
-                            if(swap_rule && ratio_bot_victories_with_swap>temp_max){
-                                temp_max = ratio_bot_victories_with_swap;
-                                temp_index_of_max = player1_first_move;
+                            // Otherwise, the Monte Carlo engine chooses the move (or the swap):
+                            Bot_Move move;
+                            if(book_move>=0){
+                                move.node = book_move;
+                                move.ratio = book_entry.win_ratio;
+                                move.nodes_and_ratios.push_back(pair<int,double>(book_move,book_entry.win_ratio));
+                            }else if(proven_winning_move>=0){
+                                move.node = proven_winning_move;
+                                move.ratio = 1.0;
+                                move.nodes_and_ratios.push_back(pair<int,double>(proven_winning_move,1.0));
+                            }else{
+                                move = bot.choose_move(state.get_position(), state.get_empty_cells(), this_is_movement_number,\
+                                player1_first_move);
+                            }
+                            // (The ratios are kept as the heatmap of this move, which can be shown over the board)
+                            last_heatmap = Heatmap(state.get_position().V(), move.nodes_and_ratios);
+                            last_heatmap.set_best_node(move.node);
+                            int temp_index_of_max = move.node;
 
-                                board.set_node_tag(temp_index_of_max, 2); // Undo the Player 1's first movement and mark it as Player 2's
-                                player_2_moves.push_back(pair<int,int>(board.nodeIndex_to_coordinate(temp_index_of_max).first,\
-                                board.nodeIndex_to_coordinate(temp_index_of_max).second));
-                                player_1_moves.pop_back(); // Delete it from the record of player 1's moves
+                            // If the swap has been chosen, use it:
+                            if(move.is_swap){
+                                state.swap(temp_index_of_max); // Undo the Player 1's first movement and mark it as Player 2's
 
                                 // Now, pass the turn to player 1
                                 current_player = (current_player%2)+1;
@@ -2023,9 +6060,7 @@ namespace Graph{
                                 cout<<"\n>>>> Bot Player 2 has used SWAP RULE and captured Player 1's first move.\n"<<endl;
 
                             }else{ // Swap rule hasn't been used
-                                board.set_node_tag(temp_index_of_max, 2);
-                                player_2_moves.push_back(pair<int,int>(board.nodeIndex_to_coordinate(temp_index_of_max).first,\
-                                board.nodeIndex_to_coordinate(temp_index_of_max).second));
+                                state.play(temp_index_of_max);
 
                                 // Now, pass the turn to player 1
                                 current_player = (current_player%2)+1;
@@ -2035,14 +6070,16 @@ namespace Graph{
                                 if(game_finished){who_won = 2;}
 
                                 cout<<"\n>>>> Player 2 has chosen the square (x, y) = ("<<\
-                                board.nodeIndex_to_coordinate(temp_index_of_max).first<<\
-                                ", "<<board.nodeIndex_to_coordinate(temp_index_of_max).second<<").\n"<<endl;
+                                state.get_position().get_topology().nodeIndex_to_coordinate(temp_index_of_max).first<<\
+                                ", "<<state.get_position().get_topology().nodeIndex_to_coordinate(temp_index_of_max).second<<").\n"<<endl;
                             }
 
                             // Update the moves counter:
                             ++this_is_movement_number;
+                            bot_time_ms += chrono::duration_cast<chrono::milliseconds>(\
+                            chrono::steady_clock::now()-bot_start).count();
 
-                            board.draw_board_ASCII(false);
+                            draw_board();
                         }
                     }
                     if(who_won==1){
@@ -2055,6 +6092,10 @@ namespace Graph{
                         cout<<"* - * - * - * - * - * - * - * - * -"<<endl;
                     }
 
+                    if(border_length<=MAX_SOLVER_BORDER_LENGTH){
+                        solver.save_cache(solver_cache_filename());
+                    }
+
                 }else{
                     int current_player = who_starts;
                     player_move_by_input(current_player);
@@ -2072,6 +6113,8 @@ namespace Graph{
                     cout<<"* - * - * - * - * - * - * - * - * -"<<endl;
                 }
 
+                save_game();
+
                 cout<<"\nEnd of game. Press E + ENTER to exit."<<endl;
                 string _aux;
                 cin>>_aux;
@@ -2081,10 +6124,13 @@ namespace Graph{
         // Class members:
         // ==============
         private:
-            Hex_Board board;
+            Game_State state; // The stones of the game (the board itself is the shared BoardTopology), with its
+            // groups and empty cells kept up to date move by move
             int border_length;
-            vector<pair<int, int>> player_1_moves;
-            vector<pair<int, int>> player_2_moves;
+            MonteCarlo_Bot bot; // Monte Carlo engine of the bot opponent
+            Hex_Solver solver; // Exact solver used by the bot on small boards
+            Opening_Book book; // Opening book of the bot (if it has been generated for this board size)
+            Pattern_Policy policy; // Pattern prior of the bot (if the weights have been trained)
             int who_starts; // Indicates whether player 1 or player 2 will do the first move
             bool vs_robot; // If true, player 2 will be the computer. If false, both players will be humans
             bool swap_rule; // If true, the second player to move will have the option to take over the first
@@ -2093,13 +6139,114 @@ namespace Graph{
             bool swap_has_been_done; // Indicates whether the second player to move has chosen to use the swap rule
             bool game_finished;
             int who_won;
+            long bot_time_ms; // Time spent by the bot choosing its moves (saved with the game)
+            Heatmap last_heatmap; // Ratios of victories of the candidates of the last bot move
+            bool show_heatmap; // If true, last_heatmap is drawn over the board
     };
 }
 
 // ==================================================================================================
 // main
 // ==================================================================================================
-int main(){
+int main(int argc, char* argv[]){
+
+    // Offline tools. When the program is run without arguments, a game is played:
+    //   --build-book <border_length> <bot_moves> <swap y/n> [iterations]
+    //       Generates the opening book of that board size (see Graph::Opening_Book_Generator)
+    //   --build-swap-map <border_length> <exact y/n> [iterations] [seed]
+    //       Computes the swap map of that board size and prints it (see Graph::Swap_Map)
+    //   --train-patterns <border_length> <n_games> [iterations]
+    //       Learns the pattern weights of the bot from self-play games (see Graph::Pattern_Trainer)
+    //   --bench-graph [max_size] [csv/json]
+    //       Measures the graph classes on random graphs and prints the results (see Graph::Graph_Benchmark)
+    //   --export-sgf <games_file> <sgf_file>
+    //       Writes the games of a game log as SGF (see Graph::Game_Log and Graph::SGF_Exporter)
+    //   --tournament <border_length> <n_games> <engine_a> <engine_b> [swap y/n] [threads] [games_file]
+    //       Plays engine-vs-engine games and prints the results (see Graph::Self_Play_Tournament). An engine
+    //       is given as its iterations and its options: p to use the pattern weights, h for sequential
+    //       halving, c for early cutoff of the random games (e.g. 750, 750p or 750ph). The border length
+    //       goes from 1 to 255, and n_games must be positive
+    //   --analyze <positions_file> <output_file> [iterations] [csv/json] [threads]
+    //       Writes the bot's ratio of victories for each empty cell of each position (see Graph::Position_Analyzer)
+    if(argc>1){
+        string mode = argv[1];
+        if(mode=="--build-book" && argc>=5){
+            int border_length = atoi(argv[2]);
+            int bot_moves = atoi(argv[3]);
+            bool swap_rule = (string(argv[4])=="y");
+            int n_iterations = (argc>=6)?atoi(argv[5]):N_MC_ITERATIONS;
+            Graph::Opening_Book_Generator generator(border_length, bot_moves, swap_rule, n_iterations);
+            bool written = generator.generate(Graph::Opening_Book::default_filename(border_length));
+            return written?0:1;
+        }else if(mode=="--build-swap-map" && argc>=4){
+            int border_length = atoi(argv[2]);
+            bool exact = (string(argv[3])=="y");
+            int n_iterations = (argc>=5)?atoi(argv[4]):N_MC_ITERATIONS;
+            uint32_t seed = (argc>=6)?strtoul(argv[5], nullptr, 10):1;
+            Graph::Swap_Map_Generator generator(border_length, exact, n_iterations, seed);
+            cout<<generator.generate()<<endl;
+            return 0;
+        }else if(mode=="--train-patterns" && argc>=4){
+            int border_length = atoi(argv[2]);
+            int n_games = atoi(argv[3]);
+            int n_iterations = (argc>=5)?atoi(argv[4]):N_MC_ITERATIONS;
+            Graph::Pattern_Trainer trainer(border_length, n_games, n_iterations);
+            bool written = trainer.train(Graph::Pattern_Policy::default_filename());
+            return written?0:1;
+        }else if(mode=="--bench-graph"){
+            int max_size = (argc>=3)?atoi(argv[2]):1000000;
+            bool json = (argc>=4 && string(argv[3])=="json");
+            Graph::Graph_Benchmark benchmark(max_size, json);
+            benchmark.run();
+            return 0;
+        }else if(mode=="--export-sgf" && argc>=4){
+            long n_games = Graph::SGF_Exporter::export_log(argv[2], argv[3]);
+            if(n_games>=0){
+                cout<<n_games<<" games written to "<<argv[3]<<endl;
+            }
+            return (n_games>=0)?0:1;
+        }else if(mode=="--tournament" && argc>=6 && atoi(argv[2])>=1 && atoi(argv[2])<=255 && atoi(argv[3])>0){
+            // (The border length is written on 8 bits in the game log. Otherwise, the usage is printed)
+            int border_length = atoi(argv[2]);
+            int n_games = atoi(argv[3]);
+            Graph::Engine_Settings engine_a = Graph::Engine_Settings::parse(argv[4]);
+            Graph::Engine_Settings engine_b = Graph::Engine_Settings::parse(argv[5]);
+            bool swap_rule = (argc>=7 && string(argv[6])=="y");
+            int n_threads = (argc>=8)?atoi(argv[7]):0;
+            Graph::Self_Play_Tournament tournament(border_length, swap_rule, n_games, engine_a, engine_b, n_threads);
+            Graph::Game_Log_Writer game_log;
+            if(argc>=9 && game_log.open(argv[8])){
+                tournament.set_game_log(&game_log);
+            }
+            tournament.print(tournament.run());
+            return 0;
+        }else if(mode=="--analyze" && argc>=4){
+            int n_iterations = (argc>=5)?atoi(argv[4]):N_MC_ITERATIONS;
+            bool json = (argc>=6 && string(argv[5])=="json");
+            int n_threads = (argc>=7)?atoi(argv[6]):0;
+            ifstream positions(argv[2]);
+            ofstream output(argv[3]);
+            if(!positions || !output){
+                cout<<"Files "<<argv[2]<<" or "<<argv[3]<<" couldn't be opened."<<endl;
+                return 1;
+            }
+            Graph::Position_Analyzer analyzer(n_iterations, json, n_threads);
+            cout<<analyzer.run(positions, output)<<" positions analyzed."<<endl;
+            return 0;
+        }else{
+            cout<<"Unknown or incomplete arguments. Usage:"<<endl;
+            cout<<"  (no arguments)                                         Play a game"<<endl;
+            cout<<"  --build-book <border_length> <bot_moves> <swap y/n> [iterations]"<<endl;
+            cout<<"  --build-swap-map <border_length> <exact y/n> [iterations] [seed]"<<endl;
+            cout<<"  --train-patterns <border_length> <n_games> [iterations]"<<endl;
+            cout<<"  --bench-graph [max_size] [csv/json]"<<endl;
+            cout<<"  --export-sgf <games_file> <sgf_file>"<<endl;
+            cout<<"  --tournament <border_length> <n_games> <engine_a> <engine_b> [swap y/n] [threads] [games_file]"<<endl;
+            cout<<"  --analyze <positions_file> <output_file> [iterations] [csv/json] [threads]"<<endl;
+            cout<<"  (Tournaments: border_length from 1 to 255 and n_games greater than 0)"<<endl;
+            return 1;
+        }
+    }
 
     // This version of the program permits playing against the computer.
     // But if so, do not use a board greater than 7x7, or the computation will be too slow!